@@ -0,0 +1,289 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <fitness_kernel.h>
+#include <generator.h>
+#include <genetic_algorithm.h>
+#include <solver.h>
+#include <skyscrapers.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// throughput and time to solution benchmarks, written to stdout as a single JSON document.
+// usage: skyscrapers-ga-bench [--seeds N] [--min-size N] [--max-size N] [--generations N] [--population N]
+
+namespace
+{
+    using clock_type = std::chrono::steady_clock;
+
+    struct options_t
+    {
+        blt::i32 seeds = 5;
+        blt::i32 min_size = 3;
+        blt::i32 max_size = 12;
+        blt::i32 generations = 200;
+        blt::i32 population = 200;
+    };
+
+    double seconds_since(const clock_type::time_point start)
+    {
+        return std::chrono::duration<double>(clock_type::now() - start).count();
+    }
+
+    const char* kernel_name(const sky::fitness_kernel_t kernel)
+    {
+        switch (kernel)
+        {
+        case sky::fitness_kernel_t::REFERENCE:
+            return "reference";
+        case sky::fitness_kernel_t::BITMASK:
+            return "bitmask";
+        case sky::fitness_kernel_t::FIXED:
+            return "fixed";
+        }
+        return "unknown";
+    }
+
+    // keeps the optimizer from discarding benchmarked work
+    volatile blt::i64 sink = 0;
+
+    std::pair<sky::problem_t, sky::solution_t> make_puzzle(const blt::i32 size, const blt::u64 seed)
+    {
+        sky::puzzle_generator_t generator{seed};
+        auto [problem, solution] = generator.generate(size);
+        return {std::move(problem), std::move(solution)};
+    }
+
+    void bench_fitness(const options_t& options)
+    {
+        std::printf("\"fitness\":[");
+        bool first = true;
+        for (blt::i32 size = options.min_size; size <= options.max_size; size++)
+        {
+            auto [problem, ignored] = make_puzzle(size, 1000 + size);
+            std::vector<sky::solution_t> boards;
+            blt::random::random_t random{static_cast<blt::u64>(size)};
+            for (blt::i32 i = 0; i < 256; i++)
+            {
+                boards.emplace_back(size);
+                boards.back().init(problem, random);
+            }
+            for (const auto kernel : {sky::fitness_kernel_t::REFERENCE, sky::fitness_kernel_t::BITMASK, sky::fitness_kernel_t::FIXED})
+            {
+                blt::u64 evaluations = 0;
+                const auto start = clock_type::now();
+                do
+                {
+                    for (const auto& board : boards)
+                        sink = sink + board.fitness(problem, kernel);
+                    evaluations += boards.size();
+                }
+                while (seconds_since(start) < 0.1);
+                std::printf("%s{\"size\":%d,\"kernel\":\"%s\",\"evaluations_per_second\":%.1f}", first ? "" : ",", size,
+                            kernel_name(kernel),
+                            static_cast<double>(evaluations) / seconds_since(start));
+                first = false;
+            }
+
+            // the same boards scored kernel::batch_lanes at a time across SIMD lanes
+            std::vector<const sky::cell_t*> pointers;
+            for (const auto& board : boards)
+                pointers.push_back(board.board_data.data());
+            std::vector<blt::i32> fitness(boards.size());
+            blt::u64 evaluations = 0;
+            const auto start = clock_type::now();
+            do
+            {
+                sky::kernel::batch_line_scores(problem, pointers.data(), pointers.size(), fitness.data());
+                sink = sink + fitness.back();
+                evaluations += boards.size();
+            }
+            while (seconds_since(start) < 0.1);
+            std::printf(",{\"size\":%d,\"kernel\":\"batch\",\"evaluations_per_second\":%.1f}", size,
+                        static_cast<double>(evaluations) / seconds_since(start));
+        }
+        std::printf("]");
+    }
+
+    void bench_operators(const options_t& options)
+    {
+        std::printf("\"operators\":[");
+        bool first = true;
+        for (const auto size : {6, 9})
+        {
+            if (size < options.min_size || size > options.max_size)
+                continue;
+            auto [problem, ignored] = make_puzzle(size, 2000 + size);
+            // fixed seeds so every run of the benchmark measures the same work
+            sky::genetic_algorithm ga{problem, 1000, 0.8, 0.1, static_cast<blt::u64>(size)};
+            auto& random = ga.get_random();
+            const auto& population = ga.get_population();
+            std::vector<sky::cell_t> first_child(static_cast<blt::size_t>(size) * size), second_child(first_child.size());
+            sky::dirty_lines_t first_dirty{size}, second_dirty{size};
+
+            const auto measure = [&](const char* name, auto&& op)
+            {
+                blt::u64 calls = 0;
+                const auto start = clock_type::now();
+                do
+                {
+                    for (blt::i32 i = 0; i < 1024; i++)
+                        op(i);
+                    calls += 1024;
+                }
+                while (seconds_since(start) < 0.1);
+                std::printf("%s{\"size\":%d,\"operator\":\"%s\",\"calls_per_second\":%.1f}", first ? "" : ",", size, name,
+                            static_cast<double>(calls) / seconds_since(start));
+                first = false;
+            };
+
+            measure("crossover", [&](const blt::i32 i)
+            {
+                first_dirty.clear();
+                second_dirty.clear();
+                ga.crossover(population.cells(i % 1000), population.cells((i + 1) % 1000), first_child.data(), second_child.data(), first_dirty,
+                             second_dirty, random);
+            });
+            measure("mutate", [&](const blt::i32 i)
+            {
+                first_dirty.clear();
+                ga.mutate(population.cells(i % 1000), first_child.data(), first_dirty, random);
+            });
+            measure("select", [&](blt::i32)
+            {
+                sink = sink + static_cast<blt::i64>(ga.select(5, random));
+            });
+        }
+        std::printf("]");
+    }
+
+    void bench_run_step(const options_t& options)
+    {
+        std::printf("\"run_step\":[");
+        bool first = true;
+        for (const auto size : {6, 9})
+        {
+            if (size < options.min_size || size > options.max_size)
+                continue;
+            auto [problem, ignored] = make_puzzle(size, 3000 + size);
+            for (const auto population : {100, 1000, 10000})
+            {
+                sky::genetic_algorithm ga{problem, population, 0.8, 0.1, static_cast<blt::u64>(population)};
+                blt::u64 generations = 0;
+                const auto start = clock_type::now();
+                do
+                {
+                    ga.run_step();
+                    ++generations;
+                }
+                while (seconds_since(start) < 0.25);
+                std::printf("%s{\"size\":%d,\"population\":%d,\"generations_per_second\":%.2f}", first ? "" : ",", size, population,
+                            static_cast<double>(generations) / seconds_since(start));
+                first = false;
+            }
+        }
+        std::printf("]");
+    }
+
+    void print_distribution(const char* name, std::vector<double> times)
+    {
+        std::printf("\"%s\":{", name);
+        if (times.empty())
+        {
+            std::printf("}");
+            return;
+        }
+        std::sort(times.begin(), times.end());
+        const auto at = [&times](const double q)
+        {
+            return times[std::min(times.size() - 1, static_cast<blt::size_t>(q * static_cast<double>(times.size())))];
+        };
+        std::printf("\"min\":%.6f,\"median\":%.6f,\"p90\":%.6f,\"max\":%.6f}", times.front(), at(0.5), at(0.9), times.back());
+    }
+
+    void bench_time_to_solution(const options_t& options)
+    {
+        std::printf("\"time_to_solution\":[");
+        for (blt::i32 size = options.min_size; size <= options.max_size; size++)
+        {
+            std::vector<double> ga_times, exact_times;
+            blt::i32 ga_solved = 0;
+            for (blt::i32 seed = 0; seed < options.seeds; seed++)
+            {
+                auto [problem, ignored] = make_puzzle(size, static_cast<blt::u64>(size) * 7919 + seed);
+
+                auto start = clock_type::now();
+                sky::genetic_algorithm ga{problem, options.population, 0.8, 0.1, static_cast<blt::u64>(seed)};
+                const auto best = ga.solve(options.generations);
+                if (best.fitness(problem) == 0)
+                {
+                    ++ga_solved;
+                    ga_times.push_back(seconds_since(start));
+                }
+
+                if (size <= sky::backtracking_solver_t::fast_path_board_size)
+                {
+                    start = clock_type::now();
+                    sky::backtracking_solver_t solver{problem};
+                    if (solver.solve())
+                        exact_times.push_back(seconds_since(start));
+                }
+            }
+            std::printf("%s{\"size\":%d,\"seeds\":%d,\"ga_solved\":%d,", size == options.min_size ? "" : ",", size, options.seeds, ga_solved);
+            print_distribution("ga_seconds", ga_times);
+            std::printf(",");
+            print_distribution("exact_seconds", exact_times);
+            std::printf("}");
+        }
+        std::printf("]");
+    }
+}
+
+int main(const int argc, const char** argv)
+{
+    options_t options;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const auto value = std::atoi(argv[i + 1]);
+        if (std::strcmp(argv[i], "--seeds") == 0)
+            options.seeds = value;
+        else if (std::strcmp(argv[i], "--min-size") == 0)
+            options.min_size = std::max(value, 2);
+        else if (std::strcmp(argv[i], "--max-size") == 0)
+            options.max_size = value;
+        else if (std::strcmp(argv[i], "--generations") == 0)
+            options.generations = value;
+        else if (std::strcmp(argv[i], "--population") == 0)
+            options.population = value;
+    }
+
+    std::printf("{");
+    bench_fitness(options);
+    std::printf(",");
+    bench_operators(options);
+    std::printf(",");
+    bench_run_step(options);
+    std::printf(",");
+    bench_time_to_solution(options);
+    std::printf("}\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,41 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ALLOCATION_TRACKER_H
+#define ALLOCATION_TRACKER_H
+
+#include <blt/std/types.h>
+
+// process wide heap allocation counters. only active when built with SKYSCRAPERS_GA_TRACK_ALLOCATIONS (cmake TRACK_ALLOCATIONS),
+// which replaces the global operator new. otherwise every counter reads zero
+namespace sky::allocations
+{
+#ifdef SKYSCRAPERS_GA_TRACK_ALLOCATIONS
+    constexpr bool enabled = true;
+#else
+    constexpr bool enabled = false;
+#endif
+
+    // number of calls to operator new since the program started
+    [[nodiscard]] blt::u64 count();
+
+    // total bytes requested from operator new since the program started
+    [[nodiscard]] blt::u64 bytes();
+}
+
+#endif //ALLOCATION_TRACKER_H
@@ -0,0 +1,90 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <corpus.h>
+#include <genetic_algorithm.h>
+#include <rng.h>
+#include <run_controller.h>
+#include <skyscrapers.h>
+
+namespace sky
+{
+    struct batch_config_t
+    {
+        // threads solving puzzles concurrently, each puzzle runs its genetic algorithm on a single thread. 0 uses every hardware thread
+        blt::size_t workers = 0;
+        blt::i32 individual_count = 500;
+        double crossover_rate = 0.8;
+        double mutation_rate = 0.1;
+        blt::i32 elites = 2;
+        blt::i32 k = 5;
+        encoding_t encoding = encoding_t::CELLS;
+        replacement_config_t replacement;
+        steady_state_config_t steady;
+        evaluation_t evaluation = evaluation_t::INLINE;
+        // job j of a batch runs with the seed stream j of this one (see rng.h), so results do not depend on the worker count
+        blt::u64 seed = rng::random_seed();
+        // per puzzle generation / time budgets and stagnation handling
+        run_controller_config_t control;
+        // puzzles small enough are handed to the exact solver first (see solver.h), falling back to the genetic algorithm
+        // if it gives up after this many nodes. the time it took counts against control.time_limit_seconds
+        bool exact_fast_path = true;
+        blt::u64 exact_node_limit = 1000000;
+    };
+
+    struct batch_result_t
+    {
+        std::string file;
+        // empty when the file could not be parsed
+        std::optional<solution_t> solution;
+        blt::i32 fitness = -1;
+        blt::i32 generations = 0;
+        double seconds = 0;
+        bool exact = false;
+        std::string error;
+    };
+
+    // a directory yields every regular file inside it (sorted by name), anything else is read as a manifest with one puzzle path per line.
+    // relative manifest entries are resolved against the manifest's directory
+    std::vector<std::string> collect_batch_files(std::string_view path);
+
+    batch_result_t solve_batch_job(const std::string& file, const batch_config_t& config);
+
+    // solves an already parsed puzzle, name is what the result reports as its file
+    batch_result_t solve_batch_problem(std::string name, const problem_t& problem, const batch_config_t& config);
+
+    // writes a result as a single line JSON object, without the trailing newline
+    void write_batch_result(std::ostream& out, const batch_result_t& result);
+
+    // solves every file, balancing jobs between workers by work stealing. each result is written to out as a JSON line as soon as its
+    // job finishes, so lines are in completion order. returns the number of puzzles solved
+    blt::size_t run_batch(const std::vector<std::string>& files, const batch_config_t& config, std::ostream& out);
+
+    // same as above for every puzzle of a packed corpus (see corpus.h), read straight from its mapping. results name puzzles name#index
+    blt::size_t run_batch(const corpus_t& corpus, const std::string& name, const batch_config_t& config, std::ostream& out);
+}
+
+#endif //BATCH_H
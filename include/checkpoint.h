@@ -0,0 +1,173 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <skyscrapers.h>
+#include <blt/std/expected.h>
+
+namespace sky
+{
+    class genetic_algorithm;
+
+    // snapshot layout: this header, then at the given (8 byte aligned) offsets the clues (top, bottom, left, right as i32), the packed
+    // boards (board_size^2 bytes each), the line scores (2 * board_size i32 each) and the fitness of every individual (i32)
+    struct checkpoint_header_t
+    {
+        static constexpr char expected_magic[8] = {'S', 'K', 'Y', 'C', 'K', 'P', 'T', '\0'};
+        static constexpr blt::u32 current_version = 7;
+
+        char magic[8];
+        blt::u32 version;
+        blt::i32 board_size;
+        blt::u64 individual_count;
+        blt::u64 generation;
+        // seed every stream of the run derives from, the control stream included (see genetic_algorithm::get_random)
+        blt::u64 run_seed;
+        double crossover_rate;
+        double mutation_rate;
+        double selection_pressure;
+        blt::u32 kernel;
+        blt::u32 selection;
+        blt::u32 local_search_mode;
+        blt::u32 duplicate_policy;
+        blt::i32 local_search_elites;
+        blt::i32 local_search_max_moves;
+        blt::i32 local_search_tabu_tenure;
+        // row tables are rebuilt on resume rather than stored, with the same entry limit so they sample the same rows
+        blt::u32 encoding;
+        blt::u64 max_row_entries;
+        blt::u32 replacement_mode;
+        blt::u64 replacement_neighbourhood;
+        double sharing_radius;
+        blt::u64 steady_births;
+        blt::u32 steady_victim;
+        blt::u32 evaluation;
+        blt::u64 cache_entries;
+        blt::u64 clues_offset;
+        blt::u64 cells_offset;
+        blt::u64 scores_offset;
+        blt::u64 fitness_offset;
+        blt::u64 file_size;
+    };
+
+    static_assert(std::is_trivially_copyable_v<checkpoint_header_t>);
+
+    // a read only, memory mapped snapshot. the views point straight into the mapping and live as long as this object
+    class checkpoint_t
+    {
+    public:
+        enum class error_t
+        {
+            UNABLE_TO_OPEN,
+            BAD_MAGIC,
+            UNSUPPORTED_VERSION,
+            TRUNCATED
+        };
+
+        static blt::expected<checkpoint_t, error_t> open(std::string_view path);
+
+        checkpoint_t(const checkpoint_t&) = delete;
+        checkpoint_t& operator=(const checkpoint_t&) = delete;
+
+        checkpoint_t(checkpoint_t&& move) noexcept;
+        checkpoint_t& operator=(checkpoint_t&& move) noexcept;
+
+        ~checkpoint_t();
+
+        [[nodiscard]] const checkpoint_header_t& header() const
+        {
+            return *reinterpret_cast<const checkpoint_header_t*>(data);
+        }
+
+        // rebuilds the clues, domains are not stored and get propagated again by the genetic algorithm
+        [[nodiscard]] problem_t problem() const;
+
+        [[nodiscard]] const cell_t* cells(const blt::size_t index) const
+        {
+            const auto cell_count = static_cast<blt::size_t>(header().board_size) * header().board_size;
+            return reinterpret_cast<const cell_t*>(data + header().cells_offset) + index * cell_count;
+        }
+
+        [[nodiscard]] const blt::i32* line_scores(const blt::size_t index) const
+        {
+            return reinterpret_cast<const blt::i32*>(data + header().scores_offset) + index * header().board_size * 2;
+        }
+
+        [[nodiscard]] blt::i32 fitness(const blt::size_t index) const
+        {
+            return reinterpret_cast<const blt::i32*>(data + header().fitness_offset)[index];
+        }
+
+    private:
+        checkpoint_t(const unsigned char* data, const blt::size_t size): data(data), size(size)
+        {
+        }
+
+        const unsigned char* data = nullptr;
+        blt::size_t size = 0;
+    };
+
+    // serializes the full state of a run into buffer, reusing its storage
+    void write_checkpoint(const genetic_algorithm& ga, std::vector<unsigned char>& buffer);
+
+    // writes the snapshot to a temporary file and renames it over path, so an interrupted write never destroys the previous checkpoint
+    bool save_checkpoint(std::string_view path, const genetic_algorithm& ga);
+
+    // saves checkpoints from a background thread. only serializing the state happens on the calling thread, a snapshot still waiting
+    // to be written when the next one arrives is replaced by it
+    class checkpoint_writer_t
+    {
+    public:
+        explicit checkpoint_writer_t(std::string path);
+
+        checkpoint_writer_t(const checkpoint_writer_t&) = delete;
+        checkpoint_writer_t& operator=(const checkpoint_writer_t&) = delete;
+
+        // writes whatever is still pending before returning
+        ~checkpoint_writer_t();
+
+        void save(const genetic_algorithm& ga);
+
+        // blocks until every snapshot handed to save has been written
+        void wait();
+
+    private:
+        void loop();
+
+        std::string path;
+        // serialized on the calling thread, swapped with pending, which the writer swaps with writing
+        std::vector<unsigned char> staging, pending, writing;
+        std::mutex mutex;
+        std::condition_variable wake, idle;
+        bool has_pending = false;
+        bool busy = false;
+        bool stopping = false;
+        std::thread thread;
+    };
+}
+
+#endif //CHECKPOINT_H
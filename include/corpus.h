@@ -0,0 +1,150 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <skyscrapers.h>
+#include <blt/std/expected.h>
+
+// many puzzles packed into a single file, read through a memory mapping without any parsing
+namespace sky
+{
+    // file layout: this header, an index of puzzle_count u64 record offsets at index_offset, then the records. a record is the board size
+    // (u8), its flags (u8), the clues as u8 (top, bottom, left, right, board_size each, 0 when missing) and when flagged the reference
+    // solution as board_size^2 cells
+    struct corpus_header_t
+    {
+        static constexpr char expected_magic[8] = {'S', 'K', 'Y', 'C', 'O', 'R', 'P', '\0'};
+        static constexpr blt::u32 current_version = 1;
+
+        char magic[8];
+        blt::u32 version;
+        blt::u32 reserved;
+        blt::u64 puzzle_count;
+        blt::u64 index_offset;
+        blt::u64 file_size;
+    };
+
+    static_assert(std::is_trivially_copyable_v<corpus_header_t>);
+
+    // a single puzzle of a corpus, pointing straight into its mapping
+    struct puzzle_view_t
+    {
+        static constexpr blt::u8 has_solution_flag = 0x1;
+
+        blt::i32 board_size = 0;
+        const blt::u8* clues = nullptr;
+        // null when the corpus holds no reference solution for this puzzle
+        const cell_t* solution = nullptr;
+
+        [[nodiscard]] const blt::u8* top() const
+        {
+            return clues;
+        }
+
+        [[nodiscard]] const blt::u8* bottom() const
+        {
+            return clues + board_size;
+        }
+
+        [[nodiscard]] const blt::u8* left() const
+        {
+            return clues + board_size * 2;
+        }
+
+        [[nodiscard]] const blt::u8* right() const
+        {
+            return clues + board_size * 3;
+        }
+
+        // overwrites problem with these clues, reusing its storage. domains are not propagated
+        void fill(problem_t& problem) const;
+
+        [[nodiscard]] problem_t to_problem() const;
+
+        // only valid when solution is not null
+        [[nodiscard]] solution_t to_solution() const;
+    };
+
+    // a read only, memory mapped corpus. every view lives as long as this object
+    class corpus_t
+    {
+    public:
+        enum class error_t
+        {
+            UNABLE_TO_OPEN,
+            BAD_MAGIC,
+            UNSUPPORTED_VERSION,
+            TRUNCATED
+        };
+
+        // validates the header and every record offset, the records themselves are only touched when viewed
+        static blt::expected<corpus_t, error_t> open(std::string_view path);
+
+        // true when the file starts with the corpus magic, used to tell a corpus from a manifest
+        static bool is_corpus(std::string_view path);
+
+        corpus_t(const corpus_t&) = delete;
+        corpus_t& operator=(const corpus_t&) = delete;
+
+        corpus_t(corpus_t&& move) noexcept;
+        corpus_t& operator=(corpus_t&& move) noexcept;
+
+        ~corpus_t();
+
+        [[nodiscard]] const corpus_header_t& header() const
+        {
+            return *reinterpret_cast<const corpus_header_t*>(data);
+        }
+
+        [[nodiscard]] blt::size_t size() const
+        {
+            return header().puzzle_count;
+        }
+
+        [[nodiscard]] puzzle_view_t operator[](blt::size_t index) const;
+
+    private:
+        corpus_t(const unsigned char* data, const blt::size_t size): data(data), map_size(size)
+        {
+        }
+
+        [[nodiscard]] const blt::u64* index() const
+        {
+            return reinterpret_cast<const blt::u64*>(data + header().index_offset);
+        }
+
+        const unsigned char* data = nullptr;
+        blt::size_t map_size = 0;
+    };
+
+    // packs the problems (and the solutions, where not null) into a corpus. solutions may be empty or hold one entry per problem.
+    // returns false if the file could not be written or a board is too large for a u8 clue
+    bool write_corpus(std::string_view path, const std::vector<problem_t>& problems, const std::vector<const solution_t*>& solutions = {});
+
+    // converts text puzzle files (see puzzle_from_file) into a corpus, carrying over their solution blocks. unreadable files are
+    // skipped with a warning. returns the number of puzzles packed, or -1 if the corpus could not be written
+    blt::i64 pack_corpus(std::string_view path, const std::vector<std::string>& files);
+}
+
+#endif //CORPUS_H
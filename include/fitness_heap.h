@@ -0,0 +1,87 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FITNESS_HEAP_H
+#define FITNESS_HEAP_H
+
+#include <vector>
+#include <skyscrapers.h>
+
+namespace sky
+{
+    // indexed min / max heap over the fitness of every member of a population. the fittest and the worst member are found in constant
+    // time and a member whose fitness changed is moved in logarithmic time, so replacing individuals in place never sorts the population.
+    // equal fitness is ordered by index so the heap is deterministic
+    class fitness_heap_t
+    {
+    public:
+        // O(n) heapify of both sides
+        void build(const std::vector<blt::i32>& fitness);
+
+        [[nodiscard]] blt::size_t size() const
+        {
+            return keys.size();
+        }
+
+        [[nodiscard]] bool empty() const
+        {
+            return keys.empty();
+        }
+
+        [[nodiscard]] blt::size_t best() const
+        {
+            return min_side.heap.front();
+        }
+
+        [[nodiscard]] blt::size_t worst() const
+        {
+            return max_side.heap.front();
+        }
+
+        [[nodiscard]] blt::i32 fitness(const blt::size_t index) const
+        {
+            return keys[index];
+        }
+
+        // changes the fitness of a member, restoring the order of both sides
+        void update(blt::size_t index, blt::i32 fitness);
+
+    private:
+        // heap holds member indexes, position[member] is where the member sits in heap
+        struct side_t
+        {
+            std::vector<blt::size_t> heap;
+            std::vector<blt::size_t> position;
+        };
+
+        // true when a belongs above b. the min side keeps the fittest (lowest) member on top, the max side the worst
+        [[nodiscard]] bool above(bool max, blt::size_t a, blt::size_t b) const;
+
+        void sift_up(side_t& side, bool max, blt::size_t at);
+
+        void sift_down(side_t& side, bool max, blt::size_t at);
+
+        void swap(side_t& side, blt::size_t a, blt::size_t b);
+
+        std::vector<blt::i32> keys;
+        side_t min_side;
+        side_t max_side;
+    };
+}
+
+#endif //FITNESS_HEAP_H
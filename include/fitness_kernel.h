@@ -0,0 +1,94 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FITNESS_KERNEL_H
+#define FITNESS_KERNEL_H
+
+#include <skyscrapers.h>
+#include <cstdlib>
+
+namespace sky
+{
+    // scores a raw row major board of problem.board_size * problem.board_size cells with the chosen kernel
+    [[nodiscard]] blt::i32 score_row(const problem_t& problem, const cell_t* cells, blt::i32 row, fitness_kernel_t kernel);
+
+    [[nodiscard]] blt::i32 score_column(const problem_t& problem, const cell_t* cells, blt::i32 column, fitness_kernel_t kernel);
+
+    // scores the whole board, writing rows [0, board_size) then columns [board_size, 2 * board_size) into line_scores if not null
+    blt::i32 score_lines(const problem_t& problem, const cell_t* cells, blt::i32* line_scores, fitness_kernel_t kernel);
+
+    // delta evaluation, only the dirty lines are rescored and the difference applied to fitness
+    void rescore_lines(const problem_t& problem, const cell_t* cells, blt::i32* line_scores, blt::i32& fitness, const dirty_lines_t& dirty,
+                       fitness_kernel_t kernel);
+}
+
+// the original histogram based scoring, solution_t's per line functions forward to these
+namespace sky::kernel
+{
+    // how far a view is from its clue. a clue of zero or less is missing and accepts any view, the same as the solver and row tables
+    [[nodiscard]] inline blt::i32 view_error(const blt::i32 clue, const blt::i32 sees)
+    {
+        return clue > 0 ? std::abs(clue - sees) : 0;
+    }
+
+    [[nodiscard]] blt::i32 reference_row_incorrect_count(const cell_t* cells, blt::i32 board_size, blt::i32 row);
+
+    [[nodiscard]] blt::i32 reference_column_incorrect_count(const cell_t* cells, blt::i32 board_size, blt::i32 column);
+
+    [[nodiscard]] blt::i32 reference_row_view_count(const problem_t& problem, const cell_t* cells, blt::i32 row);
+
+    [[nodiscard]] blt::i32 reference_column_view_count(const problem_t& problem, const cell_t* cells, blt::i32 column);
+}
+
+// bitmask based scoring. gives the same results as the reference solution_t functions, provided every cell is within [1, board_size].
+// duplicates are found with a per line occupancy mask, 2 * (size - popcount) is exactly the reference sum of |count - 1|.
+// view counts are branchless running max scans, the full board kernel runs them across SIMD lanes for boards up to 32 wide
+namespace sky::kernel
+{
+    // largest board handled by the vectorized scans, bigger boards use the scalar scans
+    constexpr blt::i32 max_simd_board_size = 32;
+
+    [[nodiscard]] blt::i32 bitmask_row_score(const problem_t& problem, const cell_t* cells, blt::i32 row);
+
+    [[nodiscard]] blt::i32 bitmask_column_score(const problem_t& problem, const cell_t* cells, blt::i32 column);
+
+    blt::i32 bitmask_line_scores(const problem_t& problem, const cell_t* cells, blt::i32* line_scores = nullptr);
+}
+
+// many boards at once. boards are transposed so each byte lane of a vector holds the same cell of a different board, one instruction then
+// advances the duplicate and view counts of every board in the batch
+namespace sky::kernel
+{
+    // boards scored together, one per byte lane of a 256 bit vector
+    constexpr blt::size_t batch_lanes = 32;
+
+    // scores count boards, writing the fitness of board i to fitness[i] and its line scores (laid out as in score_lines) to line_scores[i]
+    // when line_scores is not null. same results and precondition as the bitmask kernel, boards wider than max_simd_board_size are
+    // scored one at a time
+    void batch_line_scores(const problem_t& problem, const cell_t* const* boards, blt::size_t count, blt::i32* fitness,
+                           blt::i32* const* line_scores = nullptr);
+}
+
+// distance between boards, used to measure and protect population diversity
+namespace sky::kernel
+{
+    // number of positions at which the two boards differ. compares 32 (AVX2) or 16 (SSE2) cells per step, 8 otherwise
+    [[nodiscard]] blt::size_t hamming_distance(const cell_t* a, const cell_t* b, blt::size_t count);
+}
+
+#endif //FITNESS_KERNEL_H
@@ -0,0 +1,43 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FIXED_BOARD_H
+#define FIXED_BOARD_H
+
+#include <skyscrapers.h>
+
+// board size specialized scoring, selected at runtime by fitness_kernel_t::FIXED. identical results to the other kernels
+namespace sky::kernel
+{
+    // sizes with a compiled specialization, anything else falls back to the bitmask kernel
+    constexpr blt::i32 min_fixed_board_size = 3;
+    constexpr blt::i32 max_fixed_board_size = 16;
+
+    struct fixed_kernel_set_t
+    {
+        blt::i32 (*row_score)(const problem_t& problem, const cell_t* cells, blt::i32 row);
+        blt::i32 (*column_score)(const problem_t& problem, const cell_t* cells, blt::i32 column);
+        blt::i32 (*line_scores)(const problem_t& problem, const cell_t* cells, blt::i32* line_scores);
+        void (*rescore_lines)(const problem_t& problem, const cell_t* cells, blt::i32* line_scores, blt::i32& fitness, const dirty_lines_t& dirty);
+    };
+
+    // the specialization for this board size, null if there is none
+    [[nodiscard]] const fixed_kernel_set_t* fixed_kernels(blt::i32 board_size);
+}
+
+#endif //FIXED_BOARD_H
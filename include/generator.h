@@ -0,0 +1,56 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <skyscrapers.h>
+#include <blt/std/random.h>
+
+namespace sky
+{
+    struct generated_puzzle_t
+    {
+        problem_t problem;
+        // the latin square the clues were read from
+        solution_t solution;
+    };
+
+    // derives all four clue vectors from a complete board
+    problem_t problem_from_solution(const solution_t& solution);
+
+    // seeded source of random puzzles, the same seed always produces the same sequence of puzzles
+    class puzzle_generator_t
+    {
+    public:
+        explicit puzzle_generator_t(const blt::u64 seed): random(seed)
+        {
+        }
+
+        // uniformly distributed (in the limit) latin square, mixed with the jacobson-matthews markov chain starting from a cyclic square.
+        // steps <= 0 uses size^3 moves
+        solution_t random_latin_square(blt::i32 size, blt::i64 steps = 0);
+
+        generated_puzzle_t generate(blt::i32 size, blt::i64 steps = 0);
+
+    private:
+        blt::random::random_t random;
+    };
+}
+
+#endif //GENERATOR_H
@@ -19,61 +19,476 @@
 #ifndef GENETIC_ALGORITHM_H
 #define GENETIC_ALGORITHM_H
 
-#include <limits>
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <utility>
+#include <checkpoint.h>
+#include <fitness_heap.h>
+#include <hashing.h>
+#include <local_search.h>
+#include <population.h>
+#include <rng.h>
+#include <row_table.h>
+#include <selection.h>
+#include <snapshot.h>
+#include <telemetry.h>
+#include <worker_pool.h>
 #include <skyscrapers.h>
 #include <blt/std/random.h>
 
 namespace sky
 {
-    struct individual_t
+    // what happens to children identical (by hash) to another member of the generation being built
+    enum class duplicate_policy_t
     {
-        solution_t solution;
-        blt::i32 fitness = std::numeric_limits<blt::i32>::max();
+        ALLOW,
+        // mutated again in place until a cell changes, replaced with a fresh random board if it keeps coming out the same
+        REMUTATE,
+        // replaced with a fresh random board
+        REPLACE
+    };
 
-        individual_t(solution_t solution, const blt::i32 fitness): solution(std::move(solution)), fitness(fitness)
-        {
-        }
+    // how operators treat a board
+    enum class encoding_t
+    {
+        // any value may go in any cell
+        CELLS,
+        // every row is a permutation agreeing with its clues (see row_table.h), operators exchange and resample whole rows
+        ROW_PERMUTATION
+    };
 
-        void replace(const problem_t& problem, const solution_t& new_solution)
-        {
-            solution = new_solution;
-            fitness = solution.fitness(problem);
-        }
+    // how a child takes its slot in the next generation
+    enum class replacement_t
+    {
+        // every child is kept
+        GENERATIONAL,
+        // parents are paired at random instead of selected. crossover children contest the closer parent (by hamming distance) and mutants
+        // their own, the parent keeps the slot when it is strictly fitter. near copies only ever push out their own kind, so niches survive
+        DETERMINISTIC_CROWDING,
+        // as above, but fitness is penalized by how crowded the board's neighbourhood in the current population is
+        FITNESS_SHARING
+    };
+
+    struct replacement_config_t
+    {
+        replacement_t mode = replacement_t::GENERATIONAL;
+        // FITNESS_SHARING only. boards closer than this fraction of their cells share a niche
+        double sharing_radius = 0.15;
+        // FITNESS_SHARING only. members of the current population sampled as the neighbourhood of each contest
+        blt::size_t neighbourhood = 8;
+    };
+
+    // when children are scored
+    enum class evaluation_t
+    {
+        // as soon as each is bred, rescoring only the lines its operator touched
+        INLINE,
+        // once a worker has bred its whole slice, fully scoring the changed ones kernel::batch_lanes at a time (see
+        // kernel::batch_line_scores). gives the same results as INLINE
+        BATCHED
+    };
+
+    // which member a steady state child pushes out
+    enum class steady_victim_t
+    {
+        WORST,
+        // the worst of k uniformly drawn members
+        TOURNAMENT_LOSER
+    };
+
+    struct steady_state_config_t
+    {
+        // children bred and inserted by each run_step, 0 (the default) builds whole generations instead
+        blt::size_t births = 0;
+        steady_victim_t victim = steady_victim_t::WORST;
     };
 
     class genetic_algorithm
     {
     public:
-        genetic_algorithm(problem_t problem, const blt::i32 individual_count, const double crossover_rate = 0.8, const double mutation_rate = 0.1):
-            crossover_rate(crossover_rate), mutation_rate(mutation_rate), m_problem(std::move(problem))
+        // every random decision of the run derives from seed (see rng.h), so two runs with the same seed and settings are identical
+        // whatever their worker count
+        genetic_algorithm(problem_t problem, const blt::i32 individual_count, const double crossover_rate = 0.8, const double mutation_rate = 0.1,
+                          const blt::u64 seed = rng::random_seed()):
+            crossover_rate(crossover_rate), mutation_rate(mutation_rate), m_problem(std::move(problem)), seed(seed),
+            control_random(rng::stream(rng::stream(seed, 0), control_stream))
         {
+            if (!m_problem.has_domains())
+                m_problem.propagate_domains();
+            populations[0].resize(m_problem.board_size, individual_count);
+            populations[1].resize(m_problem.board_size, individual_count);
+            order.resize(individual_count);
+            const auto initial_key = rng::stream(seed, initial_stream);
             for (blt::i32 i = 0; i < individual_count; i++)
             {
-                solution_t solution{problem.board_size};
-                solution.init(problem);
-                individuals.emplace_back(solution, solution.fitness(m_problem));
+                blt::random::random_t individual_random{rng::stream(initial_key, i)};
+                solution_t solution{m_problem.board_size};
+                solution.init(m_problem, individual_random);
+                populations[current].store(i, individual_t{std::move(solution), m_problem, kernel});
             }
         }
 
+        // resumes the run stored in a checkpoint (see checkpoint.h). the boards and scores are copied out of the mapping as they are,
+        // nothing is parsed or evaluated again
+        explicit genetic_algorithm(const checkpoint_t& checkpoint);
+
         void run_step(blt::i32 elites = 2, blt::i32 k = 5);
 
+        // runs generations until one reaches fitness zero or max_generations have passed, returning the best board found
+        [[nodiscard]] solution_t solve(blt::i32 max_generations, blt::i32 elites = 2, blt::i32 k = 5);
+
+        // number of threads used to build each generation. 1 (the default) builds it serially on the calling thread
+        void set_worker_count(blt::size_t count);
+
+        [[nodiscard]] blt::size_t get_worker_count() const
+        {
+            return pool ? pool->size() : 1;
+        }
+
+        // every kernel produces identical scores, this only changes how fast they are computed
+        void set_fitness_kernel(const fitness_kernel_t fitness_kernel)
+        {
+            kernel = fitness_kernel;
+        }
+
+        [[nodiscard]] fitness_kernel_t get_fitness_kernel() const
+        {
+            return kernel;
+        }
+
+        void set_evaluation(const evaluation_t mode)
+        {
+            evaluation = mode;
+        }
+
+        [[nodiscard]] evaluation_t get_evaluation() const
+        {
+            return evaluation;
+        }
+
+        // scores the members [begin, end) of a population from scratch and rehashes them, kernel::batch_lanes boards at a time
+        void evaluate_batch(population_t& population, blt::size_t begin, blt::size_t end) const;
+
+        // optional refinement of the best individuals at the end of every run_step, see local_search.h. skipped under ROW_PERMUTATION
+        void set_local_search(const local_search_config_t& config)
+        {
+            local_search = config;
+        }
+
+        [[nodiscard]] const local_search_config_t& get_local_search() const
+        {
+            return local_search;
+        }
+
+        // how parents are chosen, see selection.h. tournament selection is the default
+        void set_selection(const selection_t selection, const double pressure = 1.5)
+        {
+            selector.set_strategy(selection, pressure);
+        }
+
+        [[nodiscard]] selection_t get_selection() const
+        {
+            return selector.get_strategy();
+        }
+
+        [[nodiscard]] double get_selection_pressure() const
+        {
+            return selector.get_pressure();
+        }
+
+        // children come from crossover or mutation in proportion to these rates
+        void set_rates(const double crossover, const double mutation)
+        {
+            crossover_rate = crossover;
+            mutation_rate = mutation;
+        }
+
+        [[nodiscard]] double get_crossover_rate() const
+        {
+            return crossover_rate;
+        }
+
+        [[nodiscard]] double get_mutation_rate() const
+        {
+            return mutation_rate;
+        }
+
+        // bounded cache of scores keyed by board hash (see hashing.h), consulted before rescoring a child. 0 entries (the default) disables it
+        void set_fitness_cache(const blt::size_t entries)
+        {
+            cache.resize(entries, m_problem.board_size);
+        }
+
+        [[nodiscard]] const fitness_cache_t& get_fitness_cache() const
+        {
+            return cache;
+        }
+
+        void set_duplicate_policy(const duplicate_policy_t policy)
+        {
+            duplicate_policy = policy;
+        }
+
+        [[nodiscard]] duplicate_policy_t get_duplicate_policy() const
+        {
+            return duplicate_policy;
+        }
+
+        void set_replacement(const replacement_config_t& config)
+        {
+            replacement = config;
+        }
+
+        [[nodiscard]] const replacement_config_t& get_replacement() const
+        {
+            return replacement;
+        }
+
+        // with births set, run_step breeds that many children from the current population and overwrites members in place instead of
+        // building a new generation. a child only replaces a member at least as fit as itself, and the fittest member is kept whenever
+        // elites are asked for. the replacement mode does not apply, duplicate policies other than ALLOW reject children already present
+        void set_steady_state(const steady_state_config_t& config)
+        {
+            steady = config;
+        }
+
+        [[nodiscard]] const steady_state_config_t& get_steady_state() const
+        {
+            return steady;
+        }
+
+        // switching to ROW_PERMUTATION builds the row tables (rows with more than max_row_entries candidates are sampled instead) and
+        // replaces the whole population with boards built from them. local search is ignored while it is active
+        void set_encoding(encoding_t encoding, blt::size_t max_row_entries = row_tables_t::default_max_row_entries);
+
+        [[nodiscard]] encoding_t get_encoding() const
+        {
+            return encoding;
+        }
+
+        [[nodiscard]] const row_tables_t& get_row_tables() const
+        {
+            return row_tables;
+        }
+
         [[nodiscard]] double average_fitness() const;
 
+        [[nodiscard]] blt::i32 best_fitness() const;
+
+        // sampled hamming diversity of the current population, see population_t::diversity. the pairs come from a stream of their own so
+        // measuring never changes the course of the run
+        [[nodiscard]] double diversity(blt::size_t pairs = 64) const;
+
+        // diversity of the generation produced by the last run_step, measured with the default number of pairs
+        [[nodiscard]] double get_last_diversity() const
+        {
+            return last_diversity;
+        }
+
+        // children of the last run_step that were thrown away, either losing their slot to their parent (see replacement_t) or, in steady
+        // state, being worse than the member they would have replaced
+        [[nodiscard]] blt::u64 get_last_rejections() const
+        {
+            return last_rejections;
+        }
+
+        // replaces the worst fraction of the population with fresh random boards. the keep fittest individuals are never replaced
+        void reseed(double fraction, blt::i32 keep = 2);
+
         [[nodiscard]] std::vector<individual_t> get_best(blt::i32 amount);
 
-        [[nodiscard]] blt::random::random_t& get_random() const;
+        // replaces the worst individuals of the population with the given migrants
+        void accept_migrants(std::vector<individual_t> migrants);
+
+        [[nodiscard]] const population_t& get_population() const
+        {
+            return populations[current];
+        }
+
+        [[nodiscard]] const problem_t& get_problem() const
+        {
+            return m_problem;
+        }
+
+        // heap allocations made during the last run_step, always zero unless allocation tracking is enabled (see allocation_tracker.h)
+        [[nodiscard]] blt::u64 get_last_step_allocations() const
+        {
+            return last_step_allocations;
+        }
+
+        // pushes a generation_record_t into the ring at the end of every run_step. null (the default) also disables the phase timers
+        void set_telemetry(telemetry_ring_t* ring)
+        {
+            telemetry = ring;
+        }
+
+        // publishes the best board and the generation's statistics into the buffer at the end of every run_step, for a viewer on another
+        // thread. the buffer must be sized for this problem's board. null (the default) disables it
+        void set_snapshot_buffer(snapshot_buffer_t* buffer)
+        {
+            snapshots = buffer;
+        }
+
+        // run_step calls made so far
+        [[nodiscard]] blt::u64 get_generation() const
+        {
+            return generation;
+        }
 
-        [[nodiscard]] const solution_t& select(blt::i32 k = 5) const;
+        [[nodiscard]] blt::u64 get_seed() const
+        {
+            return seed;
+        }
 
-        [[nodiscard]] std::pair<solution_t, solution_t> crossover(solution_t first, solution_t second) const;
+        // the run's control stream, used by the serial parts of a step (selection tables, duplicate removal, local search) and by callers
+        // between steps. it restarts from (seed, generation) at the end of every run_step, so a checkpoint needs no state of its own to
+        // resume it. only safe to use from the thread driving the run
+        [[nodiscard]] blt::random::random_t& get_random() const
+        {
+            return control_random;
+        }
 
-        [[nodiscard]] solution_t mutate(solution_t individual) const;
+        // index of a parent within the current population, chosen by the configured selection strategy.
+        // k is the tournament size, only used by tournament selection. draw is the position of the pick within the generation
+        [[nodiscard]] blt::size_t select(blt::i32 k, blt::random::random_t& random, blt::size_t draw = 0) const;
+
+        // writes the two children of a segment swap between the parents into the destination boards, marking the lines that differ from
+        // the parent each child was copied from. second_child may be null when only one child is wanted
+        void crossover(const cell_t* first_parent, const cell_t* second_parent, cell_t* first_child, cell_t* second_child,
+                       dirty_lines_t& first_dirty, dirty_lines_t& second_dirty, blt::random::random_t& random) const;
+
+        // writes a mutated copy of the parent into child, marking the lines touched. parent and child may be the same board
+        void mutate(const cell_t* parent, cell_t* child, dirty_lines_t& dirty, blt::random::random_t& random) const;
 
     private:
+        // the two kinds of step, see set_steady_state
+        void step_generational(blt::i32 elites, blt::i32 k);
+
+        void step_steady(blt::i32 elites, blt::i32 k);
+
+        // member a steady state child overwrites
+        [[nodiscard]] blt::size_t steady_victim(blt::i32 elites, blt::i32 k);
+
+        // fills the slots [begin, end) of the population, spread over the worker pool when there is one
+        void build_range(population_t& next_generation, blt::size_t begin, blt::size_t end, blt::i32 k);
+
+        // fills the slots [begin, end) of the next generation, safe to call concurrently on disjoint ranges
+        void build_slice(population_t& next_generation, blt::size_t begin, blt::size_t end, blt::i32 k) const;
+
+        // scores a child derived from parent, skipping the work when the board did not change or its scores are cached.
+        // returns true when the child actually had to be rescored
+        bool score_child(population_t& next_generation, blt::size_t index, const cell_t* parent, const dirty_lines_t& dirty) const;
+
+        // updates the hash of a child derived from parent and fills in its cached scores, returning true when it still needs scoring
+        bool child_changed(population_t& next_generation, blt::size_t index, const cell_t* parent, const dirty_lines_t& dirty) const;
+
+        // a pair of slots bred by build_slice, kept until its children are scored and can contest their parents
+        struct bred_pair_t
+        {
+            blt::size_t slot;
+            // parents of the two slots. crossover children share both, each mutant has its own
+            blt::size_t first_parent, second_parent;
+            bool crossed, both;
+        };
+
+        // runs the replacement contests of a scored pair, returning how many children lost their slot
+        blt::u64 contest(population_t& next_generation, const bred_pair_t& pair, blt::random::random_t& random) const;
+
+        // puts the parent back into the child's slot when it wins the contest of the configured replacement mode, returning true if so
+        bool replace_child(population_t& next_generation, blt::size_t index, blt::size_t parent, blt::random::random_t& random) const;
+
+        // fitness scaled by the crowding of the board's sampled neighbourhood, see replacement_t::FITNESS_SHARING
+        [[nodiscard]] double shared_fitness(blt::i32 fitness, const cell_t* board, blt::size_t exclude, const blt::size_t* neighbours) const;
+
+        void remove_duplicates(population_t& next_generation, blt::size_t elite_count);
+
+        // overwrites a member with a fresh random board, sampled from the cell domains when present
+        void randomize(population_t& population, blt::size_t index, blt::random::random_t& random) const;
+
+        // points the control stream at the start of the current generation's, see get_random
+        void restart_control()
+        {
+            control_random = blt::random::random_t{rng::stream(rng::stream(seed, generation), control_stream)};
+        }
+
+        void refine_elites();
+
+        // row permutation versions of the operators, see encoding_t
+        void crossover_rows(const cell_t* first_parent, const cell_t* second_parent, cell_t* first_child, cell_t* second_child,
+                            dirty_lines_t& first_dirty, dirty_lines_t& second_dirty, blt::random::random_t& random) const;
+
+        void mutate_rows(cell_t* child, dirty_lines_t& dirty, blt::random::random_t& random) const;
+
+        void publish_snapshot();
+
+        // puts back any fixed cell (see problem_t::propagate_domains) an operator overwrote
+        void restore_fixed(cell_t* cells, dirty_lines_t& dirty) const;
+
+        // partially sorts the order table so its first amount entries are the indexes of the fittest individuals, best first
+        void rank_best(blt::size_t amount);
+
+        // per phase totals of the step being built, added to by every worker at the end of its slice
+        struct phase_counters_t
+        {
+            std::atomic<blt::u64> evaluations = 0;
+            std::atomic<blt::u64> rejections = 0;
+            std::atomic<blt::u64> select_ns = 0;
+            std::atomic<blt::u64> crossover_ns = 0;
+            std::atomic<blt::u64> mutate_ns = 0;
+            std::atomic<blt::u64> evaluate_ns = 0;
+        };
+
+        // ids of the sub streams of the run seed that are not a generation
+        static constexpr blt::u64 initial_stream = ~blt::u64{0} - 1;
+        static constexpr blt::u64 encoding_stream = ~blt::u64{0} - 2;
+        // sub streams of a generation's key, slots use the ids below the population size
+        static constexpr blt::u64 diversity_stream = ~blt::u64{0};
+        static constexpr blt::u64 control_stream = ~blt::u64{0} - 1;
+        static constexpr blt::u64 reseed_stream = ~blt::u64{0} - 2;
+        // sub stream of a pair's key, with one stream per attempt at re-picking an identical second parent
+        static constexpr blt::u64 retry_stream = ~blt::u64{0};
+
         double crossover_rate, mutation_rate;
+        // only exists when more than one worker is requested
+        std::unique_ptr<worker_pool_t> pool;
+        blt::u64 last_step_allocations = 0;
+        fitness_kernel_t kernel = fitness_kernel_t::FIXED;
+        evaluation_t evaluation = evaluation_t::INLINE;
         problem_t m_problem;
-        std::vector<individual_t> individuals;
+        blt::u64 seed;
+        // each slot of a generation draws from its own stream keyed by (seed, generation, slot), this one is the serial remainder
+        mutable blt::random::random_t control_random;
+        // the current generation and the one being built, swapped at the end of each step
+        population_t populations[2];
+        blt::size_t current = 0;
+        // scratch index table used when ranking the population
+        std::vector<blt::size_t> order;
+        selector_t selector;
+        local_search_config_t local_search;
+        telemetry_ring_t* telemetry = nullptr;
+        snapshot_buffer_t* snapshots = nullptr;
+        mutable phase_counters_t phase_counters;
+        mutable fitness_cache_t cache;
+        duplicate_policy_t duplicate_policy = duplicate_policy_t::ALLOW;
+        encoding_t encoding = encoding_t::CELLS;
+        replacement_config_t replacement;
+        steady_state_config_t steady;
+        // fitness order of the current population, kept up to date by steady state steps and rebuilt after anything else changed it
+        fitness_heap_t heap;
+        // board hashes of the current population, kept alongside the heap for the steady state duplicate check
+        hash_counter_t steady_hashes;
+        bool heap_stale = true;
+        double last_diversity = 0;
+        blt::u64 last_rejections = 0;
+        row_tables_t row_tables;
+        // shuffled population indexes, the parents of each slot under contested replacement
+        std::vector<blt::size_t> pairing;
+        // scratch space for duplicate removal
+        std::vector<std::pair<blt::u64, blt::size_t>> hash_order;
+        std::vector<cell_t> scratch_board;
+        dirty_lines_t scratch_dirty{0};
+        blt::u64 generation = 0;
     };
 }
 
@@ -0,0 +1,126 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HASHING_H
+#define HASHING_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <skyscrapers.h>
+
+namespace sky
+{
+    // zobrist key of a value at a flat cell index. keys are derived with splitmix64 instead of looked up, so boards of any size
+    // share the same hash function without a size^3 table
+    inline blt::u64 zobrist_key(const blt::size_t index, const cell_t value)
+    {
+        blt::u64 z = (static_cast<blt::u64>(index) << 8 | value) * 0x9E3779B97F4A7C15ull + 0x632BE59BD9B4E019ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    blt::u64 zobrist_hash(const cell_t* cells, blt::i32 board_size);
+
+    // moves the hash of before to the hash of after. only cells inside both a dirty row and a dirty column are compared, every operator
+    // marks the row and column of each cell it changes. returns false when no cell actually changed
+    bool zobrist_update(blt::u64& hash, const cell_t* before, const cell_t* after, const dirty_lines_t& dirty);
+
+    // bounded, direct mapped map from board hash to its line scores and fitness, safe to share between threads.
+    // entries are guarded by a per slot sequence counter, a racing reader simply misses and a racing writer skips the store
+    class fitness_cache_t
+    {
+    public:
+        // entries is rounded up to a power of two, 0 disables the cache. clears every entry
+        void resize(blt::size_t entries, blt::i32 board_size);
+
+        [[nodiscard]] bool enabled() const
+        {
+            return slots != nullptr;
+        }
+
+        [[nodiscard]] blt::size_t get_capacity() const
+        {
+            return enabled() ? mask + 1 : 0;
+        }
+
+        // copies the cached scores out on a hit, line_scores and fitness are left untouched on a miss
+        bool lookup(blt::u64 hash, blt::i32* line_scores, blt::i32& fitness) const;
+
+        void insert(blt::u64 hash, const blt::i32* line_scores, blt::i32 fitness);
+
+        [[nodiscard]] blt::u64 get_hits() const
+        {
+            return hits.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] blt::u64 get_misses() const
+        {
+            return misses.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct slot_t
+        {
+            // odd while a writer owns the slot
+            std::atomic<blt::u32> sequence = 0;
+            std::atomic<blt::i32> fitness = 0;
+            std::atomic<blt::u64> hash = 0;
+        };
+
+        std::unique_ptr<slot_t[]> slots;
+        // line scores of slot i are scores[i * line_count, (i + 1) * line_count)
+        std::unique_ptr<std::atomic<blt::i32>[]> scores;
+        blt::size_t mask = 0;
+        blt::size_t line_count = 0;
+        mutable std::atomic<blt::u64> hits = 0;
+        mutable std::atomic<blt::u64> misses = 0;
+    };
+
+    // how many members hold each board hash, an open addressed table with linear probing. sized for at most members distinct hashes,
+    // so it stays at most half full and never allocates between resets
+    class hash_counter_t
+    {
+    public:
+        // forgets every hash, reusing the storage when it is already large enough
+        void reset(blt::size_t members);
+
+        void add(blt::u64 hash);
+
+        // the hash must have been added
+        void remove(blt::u64 hash);
+
+        [[nodiscard]] bool contains(blt::u64 hash) const;
+
+    private:
+        struct slot_t
+        {
+            blt::u64 hash = 0;
+            // 0 marks an empty slot
+            blt::u32 count = 0;
+        };
+
+        [[nodiscard]] blt::size_t find(blt::u64 hash) const;
+
+        std::vector<slot_t> slots;
+        blt::size_t mask = 0;
+    };
+}
+
+#endif //HASHING_H
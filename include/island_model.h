@@ -0,0 +1,162 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ISLAND_MODEL_H
+#define ISLAND_MODEL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <genetic_algorithm.h>
+#include <rng.h>
+
+namespace sky
+{
+    struct island_config_t
+    {
+        blt::i32 individual_count = 500;
+        double crossover_rate = 0.8;
+        double mutation_rate = 0.1;
+    };
+
+    enum class migration_topology_t
+    {
+        // island i sends to island i + 1
+        RING,
+        // each migration picks a different island at random
+        RANDOM
+    };
+
+    // lock-free mailbox holding the most recent batch of migrants sent to an island.
+    // any number of islands can post, a newer batch replaces one the owner has not yet taken
+    class migrant_mailbox_t
+    {
+    public:
+        migrant_mailbox_t() = default;
+
+        migrant_mailbox_t(const migrant_mailbox_t&) = delete;
+        migrant_mailbox_t& operator=(const migrant_mailbox_t&) = delete;
+
+        ~migrant_mailbox_t()
+        {
+            delete slot.load();
+        }
+
+        void post(std::unique_ptr<std::vector<individual_t>> migrants)
+        {
+            delete slot.exchange(migrants.release(), std::memory_order_acq_rel);
+        }
+
+        [[nodiscard]] std::unique_ptr<std::vector<individual_t>> take()
+        {
+            return std::unique_ptr<std::vector<individual_t>>(slot.exchange(nullptr, std::memory_order_acq_rel));
+        }
+
+    private:
+        std::atomic<std::vector<individual_t>*> slot = nullptr;
+    };
+
+    // blocks each of count threads until all of them have arrived, reusable
+    class island_barrier_t
+    {
+    public:
+        explicit island_barrier_t(const blt::size_t count): count(count)
+        {
+        }
+
+        void arrive_and_wait()
+        {
+            std::unique_lock lock{mutex};
+            const auto arrived_phase = phase;
+            if (++waiting == count)
+            {
+                waiting = 0;
+                ++phase;
+                released.notify_all();
+                return;
+            }
+            released.wait(lock, [this, arrived_phase]()
+            {
+                return phase != arrived_phase;
+            });
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable released;
+        blt::size_t count;
+        blt::size_t waiting = 0;
+        blt::u64 phase = 0;
+    };
+
+    // runs several independent populations on their own threads, periodically exchanging their best individuals
+    class island_model_t
+    {
+    public:
+        // island i runs with the seed stream i of seed (see rng.h)
+        island_model_t(const problem_t& problem, const std::vector<island_config_t>& configs, blt::i32 migration_interval = 10,
+                       blt::i32 migrant_count = 2, migration_topology_t topology = migration_topology_t::RING,
+                       blt::u64 seed = rng::random_seed());
+
+        // by default islands run freely and take whatever migrants have arrived, so runs depend on thread timing. in lockstep the islands
+        // meet at every migration (and only notice a solution there), making a run reproducible from its seed
+        void set_lockstep(const bool enabled)
+        {
+            lockstep = enabled;
+        }
+
+        // runs every island for up to the given number of generations, stopping all of them early once any island reaches fitness zero.
+        // returns the number of generations run by the island that ran the longest
+        blt::i32 run(blt::i32 generations, blt::i32 elites = 2, blt::i32 k = 5);
+
+        // best individuals across all islands, must not be called while run() is active
+        [[nodiscard]] std::vector<individual_t> get_best(blt::i32 amount);
+
+        [[nodiscard]] genetic_algorithm& get_island(const blt::size_t index)
+        {
+            return *islands[index];
+        }
+
+        [[nodiscard]] blt::size_t island_count() const
+        {
+            return islands.size();
+        }
+
+    private:
+        blt::i32 run_island(blt::size_t index, blt::i32 generations, blt::i32 elites, blt::i32 k);
+
+        blt::i32 run_island_lockstep(blt::size_t index, blt::i32 generations, blt::i32 elites, blt::i32 k, island_barrier_t& barrier);
+
+        [[nodiscard]] blt::size_t migration_target(blt::size_t index) const;
+
+        blt::i32 migration_interval, migrant_count;
+        migration_topology_t topology;
+        std::vector<std::unique_ptr<genetic_algorithm>> islands;
+        std::vector<std::unique_ptr<migrant_mailbox_t>> mailboxes;
+        std::atomic_bool solved = false;
+        bool lockstep = false;
+        // lockstep migration, each island writes only its own slot between the two barriers of an exchange
+        std::vector<std::vector<individual_t>> outgoing;
+        std::vector<blt::size_t> outgoing_targets;
+        std::unique_ptr<std::atomic_bool[]> island_solved;
+    };
+}
+
+#endif //ISLAND_MODEL_H
@@ -0,0 +1,57 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOCAL_SEARCH_H
+#define LOCAL_SEARCH_H
+
+#include <population.h>
+#include <blt/std/random.h>
+
+// refinement of single boards by swapping two cells within a row. a swap never changes the row's duplicates, so each move is scored from
+// just the affected row and its two columns using the cached line scores
+namespace sky
+{
+    enum class local_search_t
+    {
+        NONE,
+        // take the first improving swap found, until a full pass finds none or the move budget runs out
+        HILL_CLIMB,
+        // always take the best non-tabu swap, even uphill, keeping the best board seen
+        TABU
+    };
+
+    struct local_search_config_t
+    {
+        local_search_t mode = local_search_t::NONE;
+        // how many of the best individuals are refined after each generation
+        blt::i32 elites = 2;
+        // swaps evaluated per individual by HILL_CLIMB, iterations per individual for TABU
+        blt::i32 max_moves = 200;
+        // iterations a swapped cell stays tabu
+        blt::i32 tabu_tenure = 4;
+    };
+
+    // both return how much the individual's fitness improved. fixed cells are never moved
+    blt::i32 hill_climb(const problem_t& problem, population_t& population, blt::size_t index, fitness_kernel_t kernel,
+                        blt::random::random_t& random, blt::i32 max_moves);
+
+    blt::i32 tabu_search(const problem_t& problem, population_t& population, blt::size_t index, fitness_kernel_t kernel, blt::i32 iterations,
+                         blt::i32 tenure);
+}
+
+#endif //LOCAL_SEARCH_H
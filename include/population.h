@@ -0,0 +1,217 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef POPULATION_H
+#define POPULATION_H
+
+#include <limits>
+#include <new>
+#include <utility>
+#include <vector>
+#include <skyscrapers.h>
+#include <blt/std/random.h>
+
+namespace sky
+{
+    // an owning copy of a single member of the population, used wherever individuals leave the population (results, migration)
+    struct individual_t
+    {
+        solution_t solution;
+        // per line scores, rows [0, board_size) followed by columns [board_size, 2 * board_size). these always sum to fitness
+        std::vector<blt::i32> line_scores;
+        blt::i32 fitness = std::numeric_limits<blt::i32>::max();
+
+        individual_t(): solution(0)
+        {
+        }
+
+        individual_t(solution_t solution, const problem_t& problem, const fitness_kernel_t kernel = fitness_kernel_t::REFERENCE):
+            solution(std::move(solution))
+        {
+            evaluate(problem, kernel);
+        }
+
+        void replace(const problem_t& problem, const solution_t& new_solution, const fitness_kernel_t kernel = fitness_kernel_t::REFERENCE)
+        {
+            solution = new_solution;
+            evaluate(problem, kernel);
+        }
+
+        // full evaluation of every row and column
+        void evaluate(const problem_t& problem, fitness_kernel_t kernel = fitness_kernel_t::REFERENCE);
+
+        // delta evaluation, only the dirty rows and columns are rescored
+        void rescore(const problem_t& problem, const dirty_lines_t& dirty, fitness_kernel_t kernel = fitness_kernel_t::REFERENCE);
+    };
+
+    template <typename T, std::size_t Alignment>
+    struct aligned_allocator_t
+    {
+        using value_type = T;
+
+        template <typename U>
+        struct rebind
+        {
+            using other = aligned_allocator_t<U, Alignment>;
+        };
+
+        aligned_allocator_t() = default;
+
+        template <typename U>
+        explicit aligned_allocator_t(const aligned_allocator_t<U, Alignment>&)
+        {
+        }
+
+        T* allocate(const std::size_t n)
+        {
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+        }
+
+        void deallocate(T* ptr, std::size_t)
+        {
+            ::operator delete(ptr, std::align_val_t{Alignment});
+        }
+
+        friend bool operator==(const aligned_allocator_t&, const aligned_allocator_t&)
+        {
+            return true;
+        }
+
+        friend bool operator!=(const aligned_allocator_t&, const aligned_allocator_t&)
+        {
+            return false;
+        }
+    };
+
+    // every board of a generation in one contiguous block, stored as structure of arrays. individuals are addressed by index.
+    // each board starts on its own cache line. resizing to the same or a smaller shape never allocates, so a pair of these can be
+    // ping-ponged between generations without touching the heap
+    class population_t
+    {
+    public:
+        static constexpr blt::size_t cache_line_size = 64;
+
+        population_t() = default;
+
+        population_t(const blt::i32 board_size, const blt::size_t count)
+        {
+            resize(board_size, count);
+        }
+
+        void resize(blt::i32 board_size, blt::size_t count);
+
+        // frees storage left over from a larger count
+        void shrink_to_fit();
+
+        [[nodiscard]] blt::size_t size() const
+        {
+            return count;
+        }
+
+        [[nodiscard]] blt::i32 get_board_size() const
+        {
+            return board_size;
+        }
+
+        [[nodiscard]] cell_t* cells(const blt::size_t index)
+        {
+            return m_cells.data() + index * board_stride;
+        }
+
+        [[nodiscard]] const cell_t* cells(const blt::size_t index) const
+        {
+            return m_cells.data() + index * board_stride;
+        }
+
+        [[nodiscard]] blt::i32* line_scores(const blt::size_t index)
+        {
+            return m_line_scores.data() + index * board_size * 2;
+        }
+
+        [[nodiscard]] const blt::i32* line_scores(const blt::size_t index) const
+        {
+            return m_line_scores.data() + index * board_size * 2;
+        }
+
+        [[nodiscard]] blt::i32& fitness(const blt::size_t index)
+        {
+            return m_fitness[index];
+        }
+
+        [[nodiscard]] blt::i32 fitness(const blt::size_t index) const
+        {
+            return m_fitness[index];
+        }
+
+        // zobrist hash of the board, see hashing.h
+        [[nodiscard]] blt::u64 hash(const blt::size_t index) const
+        {
+            return m_hashes[index];
+        }
+
+        [[nodiscard]] const std::vector<blt::i32>& fitness_values() const
+        {
+            return m_fitness;
+        }
+
+        // copies board, scores and fitness of another population's member into the given slot
+        void copy(blt::size_t index, const population_t& from, blt::size_t from_index);
+
+        // copies only the scores, fitness and hash, for slots whose board an operator writes directly
+        void copy_scores(blt::size_t index, const population_t& from, blt::size_t from_index);
+
+        void store(blt::size_t index, const individual_t& individual);
+
+        // fills a slot from raw, already scored data
+        void assign(blt::size_t index, const cell_t* board, const blt::i32* scores, blt::i32 fitness);
+
+        [[nodiscard]] individual_t load(blt::size_t index) const;
+
+        void evaluate(blt::size_t index, const problem_t& problem, fitness_kernel_t kernel);
+
+        void rescore(blt::size_t index, const problem_t& problem, const dirty_lines_t& dirty, fitness_kernel_t kernel);
+
+        // full evaluation of the listed members at once, see kernel::batch_line_scores. hashes are left as they are
+        void evaluate_batch(const blt::size_t* indexes, blt::size_t count, const problem_t& problem);
+
+        // moves the slot's hash from the parent board it was derived from to its current board, returning false if the board is
+        // identical to the parent (the copied scores are then already correct)
+        bool update_hash(blt::size_t index, const cell_t* parent, const dirty_lines_t& dirty);
+
+        // recomputes the hash of a board modified in place
+        void rehash(blt::size_t index);
+
+        // number of cells at which the member's board differs from the given one, see kernel::hamming_distance
+        [[nodiscard]] blt::size_t distance(blt::size_t index, const cell_t* board) const;
+
+        // mean fraction of differing cells between randomly sampled pairs of boards. 0 when every board is identical
+        [[nodiscard]] double diversity(blt::size_t pairs, blt::random::random_t& random) const;
+
+    private:
+        blt::i32 board_size = 0;
+        blt::size_t count = 0;
+        // cells per board, rounded up to a whole number of cache lines
+        blt::size_t board_stride = 0;
+        std::vector<cell_t, aligned_allocator_t<cell_t, cache_line_size>> m_cells;
+        std::vector<blt::i32> m_line_scores;
+        std::vector<blt::i32> m_fitness;
+        std::vector<blt::u64> m_hashes;
+    };
+}
+
+#endif //POPULATION_H
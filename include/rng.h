@@ -0,0 +1,65 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RNG_H
+#define RNG_H
+
+#include <skyscrapers.h>
+
+// counter based random streams. the value at any position of a stream is a pure function of the stream's key and the position, so every
+// worker, individual or island can be handed its own independent stream derived from a single run seed, and a run draws the same numbers
+// no matter how its work is split between threads
+namespace sky::rng
+{
+    // splitmix64 finalizer
+    inline blt::u64 mix(blt::u64 z)
+    {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // key of the sub stream id of key. streams nest, a run's key gives a generation's key which gives an individual's key
+    inline blt::u64 stream(const blt::u64 key, const blt::u64 id)
+    {
+        return mix(key ^ mix(id * 0x9E3779B97F4A7C15ull + 0x632BE59BD9B4E019ull));
+    }
+
+    // the value at position counter of the stream
+    inline blt::u64 at(const blt::u64 key, const blt::u64 counter)
+    {
+        return mix(key + (counter + 1) * 0x9E3779B97F4A7C15ull);
+    }
+
+    // maps a random value onto [0, bound) with a multiply instead of a division
+    inline blt::u32 bounded(const blt::u64 value, const blt::u32 bound)
+    {
+        return static_cast<blt::u32>(((value >> 32) * bound) >> 32);
+    }
+
+    // seed for runs that did not ask for one
+    blt::u64 random_seed();
+
+    // positions [counter, counter + count) of the stream. positions are independent of each other so the loop vectorizes
+    void fill(blt::u64 key, blt::u64 counter, blt::u64* out, blt::size_t count);
+
+    // count cells uniform within [min, max]
+    void fill_cells(blt::u64 key, blt::u64 counter, cell_t* out, blt::size_t count, blt::i32 min, blt::i32 max);
+}
+
+#endif //RNG_H
@@ -0,0 +1,92 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ROW_TABLE_H
+#define ROW_TABLE_H
+
+#include <vector>
+#include <skyscrapers.h>
+#include <blt/std/random.h>
+
+// per row tables of every permutation of 1..N agreeing with the row's left / right clues and cell domains. a board built only from table
+// entries never has a row duplicate or a wrong row view, leaving the columns as the only source of fitness
+namespace sky
+{
+    class row_tables_t
+    {
+    public:
+        // rows with more than max_row_entries candidates (or whose search runs out of nodes) are not stored, sample() searches those
+        // randomly instead
+        static constexpr blt::size_t default_max_row_entries = 1 << 16;
+        // larger boards sample every row
+        static constexpr blt::i32 max_enumerated_board_size = 10;
+
+        void build(const problem_t& problem, blt::size_t max_row_entries = default_max_row_entries);
+
+        [[nodiscard]] bool empty() const
+        {
+            return board_size == 0;
+        }
+
+        // true when every candidate of the row is in its table
+        [[nodiscard]] bool enumerated(const blt::i32 row) const
+        {
+            return complete[row];
+        }
+
+        [[nodiscard]] blt::size_t size(const blt::i32 row) const
+        {
+            return offsets[row + 1] - offsets[row];
+        }
+
+        [[nodiscard]] const cell_t* entry(const blt::i32 row, const blt::size_t index) const
+        {
+            return entries.data() + (offsets[row] + index) * board_size;
+        }
+
+        // position of the permutation within the row's table (entries are sorted), size(row) when it is not there
+        [[nodiscard]] blt::size_t find(blt::i32 row, const cell_t* cells) const;
+
+        // writes a random candidate of the row into cells. rows without a table are found by a randomized search, which falls back to a
+        // plain shuffle of 1..N when the clues leave it without an answer
+        void sample(const problem_t& problem, blt::i32 row, blt::random::random_t& random, cell_t* cells) const;
+
+        // total permutations stored across every row
+        [[nodiscard]] blt::size_t entry_count() const
+        {
+            return offsets.empty() ? 0 : offsets.back();
+        }
+
+        // the limit the tables were last built with
+        [[nodiscard]] blt::size_t get_max_row_entries() const
+        {
+            return max_row_entries;
+        }
+
+    private:
+        blt::i32 board_size = 0;
+        blt::size_t max_row_entries = default_max_row_entries;
+        // every row's table back to back, board_size cells per entry
+        std::vector<cell_t> entries;
+        // entry index of the first permutation of each row, board_size + 1 values
+        std::vector<blt::size_t> offsets;
+        std::vector<bool> complete;
+    };
+}
+
+#endif //ROW_TABLE_H
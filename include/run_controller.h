@@ -0,0 +1,133 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUN_CONTROLLER_H
+#define RUN_CONTROLLER_H
+
+#include <functional>
+#include <vector>
+#include <genetic_algorithm.h>
+
+namespace sky
+{
+    // what the controller does once the run stagnates
+    enum class restart_policy_t
+    {
+        // keep going unchanged
+        NONE,
+        // raise the mutation rate (lowering crossover to match) while stuck, decaying back to the starting rates after each improvement
+        ADAPT_RATES,
+        // replace the worst part of the population with fresh random boards, keeping the elites
+        PARTIAL_RESTART
+    };
+
+    enum class stop_reason_t
+    {
+        SOLVED,
+        GENERATION_LIMIT,
+        TIME_LIMIT,
+        // the stop predicate asked for it
+        INTERRUPTED
+    };
+
+    struct run_controller_config_t
+    {
+        blt::i32 max_generations = 500;
+        // <= 0 means no time limit
+        double time_limit_seconds = 0;
+        bool stop_on_solution = true;
+
+        // generations of history compared when looking for stagnation
+        blt::i32 window = 25;
+        // the run stagnates when the best fitness has not improved over the window and either the average fitness improved by less than
+        // this fraction or the diversity fell below min_diversity
+        double min_average_improvement = 0.01;
+        // compared against the diversity run_step already measures, see genetic_algorithm::get_last_diversity
+        double min_diversity = 0.05;
+
+        restart_policy_t policy = restart_policy_t::ADAPT_RATES;
+        // ADAPT_RATES: mutation share is multiplied by this on every stagnation, up to max_mutation_share of the two rates
+        double mutation_growth = 1.5;
+        double max_mutation_share = 0.6;
+        // PARTIAL_RESTART: fraction of the population replaced, 0 restarts means unlimited
+        double restart_fraction = 0.5;
+        blt::i32 max_restarts = 0;
+    };
+
+    struct generation_stats_t
+    {
+        blt::i32 generation;
+        blt::i32 best_fitness;
+        double average_fitness;
+        double diversity;
+    };
+
+    struct run_report_t
+    {
+        stop_reason_t reason = stop_reason_t::GENERATION_LIMIT;
+        blt::i32 generations = 0;
+        blt::i32 best_fitness = 0;
+        blt::i32 stagnations = 0;
+        blt::i32 restarts = 0;
+        double seconds = 0;
+    };
+
+    // drives a genetic algorithm until it is solved or out of budget, reacting to stagnation as configured
+    class run_controller_t
+    {
+    public:
+        explicit run_controller_t(const run_controller_config_t& config = {}): config(config)
+        {
+        }
+
+        // called after every generation with the freshly measured statistics
+        void set_generation_callback(std::function<void(const generation_stats_t&)> callback)
+        {
+            generation_callback = std::move(callback);
+        }
+
+        // checked before every generation, the run ends as soon as it returns true. lets another thread (a viewer, a signal handler) end
+        // a run early
+        void set_stop_predicate(std::function<bool()> predicate)
+        {
+            stop_predicate = std::move(predicate);
+        }
+
+        run_report_t run(genetic_algorithm& ga, blt::i32 elites = 2, blt::i32 k = 5);
+
+        [[nodiscard]] const run_controller_config_t& get_config() const
+        {
+            return config;
+        }
+
+    private:
+        // true once the window is full and shows no meaningful progress
+        [[nodiscard]] bool stagnated(const generation_stats_t& stats) const;
+
+        run_controller_config_t config;
+        std::function<void(const generation_stats_t&)> generation_callback;
+        std::function<bool()> stop_predicate;
+        // ring buffers of the last window generations
+        std::vector<blt::i32> best_history;
+        std::vector<double> average_history;
+        blt::size_t history_size = 0;
+        blt::size_t history_head = 0;
+    };
+}
+
+#endif //RUN_CONTROLLER_H
@@ -0,0 +1,85 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SELECTION_H
+#define SELECTION_H
+
+#include <algorithm>
+#include <vector>
+#include <population.h>
+#include <blt/std/random.h>
+
+namespace sky
+{
+    enum class selection_t
+    {
+        // best of k distinct individuals
+        TOURNAMENT,
+        // linear ranking, the best individual is chosen pressure times as often as the median one
+        RANK,
+        // fitness proportional (on 1 / (1 + fitness)), all parents for the generation are drawn at once with evenly spaced pointers
+        STOCHASTIC_UNIVERSAL
+    };
+
+    class selector_t
+    {
+    public:
+        selector_t() = default;
+
+        selector_t(const selector_t&) = delete;
+        selector_t& operator=(const selector_t&) = delete;
+
+        // pressure is only used by RANK and must be within [1, 2]
+        void set_strategy(const selection_t selection, const double selection_pressure = 1.5)
+        {
+            strategy = selection;
+            pressure = std::clamp(selection_pressure, 1.0, 2.0);
+        }
+
+        [[nodiscard]] selection_t get_strategy() const
+        {
+            return strategy;
+        }
+
+        [[nodiscard]] double get_pressure() const
+        {
+            return pressure;
+        }
+
+        // builds whatever tables the strategy needs, must be called once per generation before select
+        void prepare(const population_t& population, blt::random::random_t& random);
+
+        // index of the chosen parent. k is the tournament size and ignored by the other strategies. draw is the position of this pick
+        // within the generation, STOCHASTIC_UNIVERSAL hands out its pre-drawn parents by it. safe to call from many threads at once
+        [[nodiscard]] blt::size_t select(const population_t& population, blt::i32 k, blt::random::random_t& random, blt::size_t draw) const;
+
+    private:
+        [[nodiscard]] blt::size_t tournament(const population_t& population, blt::i32 k, blt::random::random_t& random) const;
+
+        selection_t strategy = selection_t::TOURNAMENT;
+        double pressure = 1.5;
+        // population indexes ordered best first, used by RANK
+        std::vector<blt::size_t> ranked;
+        // cumulative selection probability by rank, used by RANK
+        std::vector<double> cumulative;
+        // pre-drawn parents, handed out by draw position by STOCHASTIC_UNIVERSAL
+        std::vector<blt::size_t> picks;
+    };
+}
+
+#endif //SELECTION_H
@@ -20,23 +20,45 @@
 #define SKYSCRAPERS_H
 
 #include <vector>
+#include <algorithm>
 #include <blt/std/types.h>
 #include <blt/std/expected.h>
+#include <blt/std/random.h>
+#include <optional>
 #include <string>
 #include <string_view>
 
 namespace sky
 {
+    // a single cell of a board, the height of the building in it
+    using cell_t = blt::u8;
+
+    // largest board a cell_t can describe
+    constexpr blt::i32 max_board_size = 255;
+
+    enum class fitness_kernel_t
+    {
+        // histogram + branching scans, the original implementation
+        REFERENCE,
+        // occupancy bitmasks + branchless (vectorized where possible) scans, see fitness_kernel.h
+        BITMASK,
+        // scans compiled for a specific board size (see fixed_board.h), sizes without a specialization use BITMASK
+        FIXED
+    };
+
     struct problem_t
     {
         enum class error_t
         {
             MISSING_BOARD_SIZE,
             MISSING_BOARD_DATA,
-            INCORRECT_BOARD_DATA_FOR_SIZE
+            INCORRECT_BOARD_DATA_FOR_SIZE,
+            BOARD_TOO_LARGE,
+            MISSING_SOLUTION
         };
 
         blt::i32 board_size;
+        // buildings seen from each side. a clue of zero or less is missing and any view satisfies it
         std::vector<blt::i32> top, bottom, left, right;
 
         explicit problem_t(const blt::i32 board_size): board_size(board_size)
@@ -58,6 +80,53 @@ namespace sky
         {
             return board_size;
         }
+
+        // derives the candidate values of every cell from the clues (a clue of 1 forces the max next to it, a clue of board_size forces an
+        // ascending line, a clue c caps the first c - 1 cells) then eliminates latin square conflicts until nothing changes.
+        // clues <= 0 are treated as missing. returns false, leaving every cell unconstrained, if the clues contradict each other
+        bool propagate_domains();
+
+        // forgets the propagated domains, needed whenever the clues change
+        void clear_domains()
+        {
+            domain_values.clear();
+            domain_offsets.clear();
+            fixed_cells.clear();
+        }
+
+        [[nodiscard]] bool has_domains() const
+        {
+            return !domain_offsets.empty();
+        }
+
+        // number of candidate values for the cell at the flat index, only valid once domains have been propagated
+        [[nodiscard]] blt::i32 domain_size(const blt::size_t index) const
+        {
+            return static_cast<blt::i32>(domain_offsets[index + 1] - domain_offsets[index]);
+        }
+
+        [[nodiscard]] cell_t domain_value(const blt::size_t index, const blt::i32 choice) const
+        {
+            return domain_values[domain_offsets[index] + choice];
+        }
+
+        // a cell with a single candidate, operators never change these
+        [[nodiscard]] bool is_fixed(const blt::size_t index) const
+        {
+            return has_domains() && domain_size(index) == 1;
+        }
+
+        // flat indexes of every fixed cell
+        [[nodiscard]] const std::vector<blt::u32>& get_fixed_cells() const
+        {
+            return fixed_cells;
+        }
+
+    private:
+        // candidate values of cell i are domain_values[domain_offsets[i], domain_offsets[i + 1])
+        std::vector<cell_t> domain_values;
+        std::vector<blt::u32> domain_offsets;
+        std::vector<blt::u32> fixed_cells;
     };
 
     blt::expected<problem_t, problem_t::error_t> problem_from_file(std::string_view path);
@@ -65,14 +134,15 @@ namespace sky
     struct solution_t
     {
         blt::i32 board_size;
-        std::vector<blt::i32> board_data;
+        std::vector<cell_t> board_data;
 
         explicit solution_t(const blt::i32 board_size): board_size(board_size)
         {
             board_data.resize(board_size * board_size);
         }
 
-        void init(const problem_t& problem);
+        // fills the board with random values, drawn from the cell domains when the problem has them
+        void init(const problem_t& problem, blt::random::random_t& random);
 
         // checks to see if the row contains duplicates. zero means all good
         [[nodiscard]] blt::i32 row_incorrect_count(blt::i32 row) const;
@@ -81,7 +151,13 @@ namespace sky
         [[nodiscard]] blt::i32 column_incorrect_count(blt::i32 column) const;
         [[nodiscard]] blt::i32 column_view_count(const problem_t& problem, blt::i32 column) const;
 
+        // combined duplicate + view score for a single line, these sum to fitness()
+        [[nodiscard]] blt::i32 row_score(const problem_t& problem, blt::i32 row, fitness_kernel_t kernel = fitness_kernel_t::REFERENCE) const;
+        [[nodiscard]] blt::i32 column_score(const problem_t& problem, blt::i32 column,
+                                            fitness_kernel_t kernel = fitness_kernel_t::REFERENCE) const;
+
         [[nodiscard]] blt::i32 fitness(const problem_t& problem) const;
+        [[nodiscard]] blt::i32 fitness(const problem_t& problem, fitness_kernel_t kernel) const;
 
         [[nodiscard]] blt::i32 get(const blt::i32 row, const blt::i32 column) const
         {
@@ -90,7 +166,7 @@ namespace sky
 
         void set(const blt::i32 row, const blt::i32 column, const blt::i32 value)
         {
-            board_data[row * board_size + column] = value;
+            board_data[row * board_size + column] = static_cast<cell_t>(value);
         }
 
         void print() const;
@@ -98,6 +174,75 @@ namespace sky
         void print(const problem_t& problem) const;
     };
 
+    // reads the reference solution stored after the clues of a problem file, see problem_to_file()
+    blt::expected<solution_t, problem_t::error_t> solution_from_file(std::string_view path);
+
+    struct puzzle_file_t
+    {
+        problem_t problem;
+        // empty when the file has no solution block
+        std::optional<solution_t> solution;
+    };
+
+    // reads a problem file once, along with its reference solution when it has one. a file without a solution is not an error
+    blt::expected<puzzle_file_t, problem_t::error_t> puzzle_from_file(std::string_view path);
+
+    // writes the problem in the format read by problem_from_file(). when a solution is given it is appended as a 'SOLUTION:' line followed
+    // by one line per row, which problem_from_file() skips. returns false if the file could not be written
+    bool problem_to_file(std::string_view path, const problem_t& problem, const solution_t* solution = nullptr);
+
+    // tracks which rows and columns of a board have been modified since it was last scored
+    struct dirty_lines_t
+    {
+        blt::i32 board_size;
+        std::vector<bool> rows, columns;
+
+        explicit dirty_lines_t(const blt::i32 board_size): board_size(board_size), rows(board_size, false), columns(board_size, false)
+        {
+        }
+
+        // clears every line, reusing the existing storage when the size has not grown
+        void reset(const blt::i32 size)
+        {
+            board_size = size;
+            rows.assign(size, false);
+            columns.assign(size, false);
+        }
+
+        void mark_cell(const blt::i32 row, const blt::i32 column)
+        {
+            rows[row] = true;
+            columns[column] = true;
+        }
+
+        void mark_index(const blt::size_t index)
+        {
+            mark_cell(static_cast<blt::i32>(index) / board_size, static_cast<blt::i32>(index) % board_size);
+        }
+
+        // changing a whole row touches every column
+        void mark_row(const blt::i32 row)
+        {
+            rows[row] = true;
+            std::fill(columns.begin(), columns.end(), true);
+        }
+
+        void mark_column(const blt::i32 column)
+        {
+            std::fill(rows.begin(), rows.end(), true);
+            columns[column] = true;
+        }
+
+        // marks every line touched by the flat cell range [begin, end)
+        void mark_range(blt::size_t begin, blt::size_t end);
+
+        void clear()
+        {
+            std::fill(rows.begin(), rows.end(), false);
+            std::fill(columns.begin(), columns.end(), false);
+        }
+    };
+
     problem_t make_test_problem();
 
     solution_t make_test_solution();
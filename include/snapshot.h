@@ -0,0 +1,87 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <array>
+#include <atomic>
+#include <vector>
+#include <skyscrapers.h>
+
+namespace sky
+{
+    // what a viewer needs to know about the latest generation
+    struct run_snapshot_t
+    {
+        blt::u64 generation = 0;
+        blt::i32 best_fitness = 0;
+        double average_fitness = 0;
+        double diversity = 0;
+        blt::i32 board_size = 0;
+        // the best board, board_size^2 cells
+        std::vector<cell_t> best_board;
+    };
+
+    // triple buffer handing snapshots from one writer to one reader without locks. the writer always has a buffer of its own to fill and
+    // publishing never waits; the reader always sees the newest complete snapshot and intermediate ones are simply skipped
+    class snapshot_buffer_t
+    {
+    public:
+        // sizes every board up front so publishing never allocates
+        explicit snapshot_buffer_t(blt::i32 board_size);
+
+        // the buffer owned by the writer, fill it then call publish()
+        [[nodiscard]] run_snapshot_t& write_buffer()
+        {
+            return buffers[back];
+        }
+
+        void publish()
+        {
+            back = middle.exchange(back | fresh_bit, std::memory_order_acq_rel) & index_mask;
+        }
+
+        // the newest published snapshot, only valid on the reader's thread until the next call. returns false if nothing new arrived
+        // since the last call, the previous snapshot is still readable through latest()
+        bool acquire()
+        {
+            if ((middle.load(std::memory_order_relaxed) & fresh_bit) == 0)
+                return false;
+            front = middle.exchange(front, std::memory_order_acq_rel) & index_mask;
+            return true;
+        }
+
+        [[nodiscard]] const run_snapshot_t& latest() const
+        {
+            return buffers[front];
+        }
+
+    private:
+        static constexpr blt::u8 index_mask = 0x3;
+        static constexpr blt::u8 fresh_bit = 0x4;
+
+        std::array<run_snapshot_t, 3> buffers;
+        // index of the buffer between writer and reader, with fresh_bit set when it holds an unread snapshot
+        alignas(64) std::atomic<blt::u8> middle = 1;
+        alignas(64) blt::u8 back = 0;
+        alignas(64) blt::u8 front = 2;
+    };
+}
+
+#endif //SNAPSHOT_H
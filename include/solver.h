@@ -0,0 +1,76 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <vector>
+#include <skyscrapers.h>
+#include <blt/std/expected.h>
+
+namespace sky
+{
+    // exact depth first search. every row and column tracks the values it has used as a bitmask, the most constrained open cell is
+    // filled next and partial lines are checked against their clues as soon as they are touched
+    class backtracking_solver_t
+    {
+    public:
+        enum class error_t
+        {
+            NO_SOLUTION,
+            NODE_LIMIT_REACHED,
+            BOARD_TOO_LARGE
+        };
+
+        // bit v of a mask is value v, so the largest value must fit in a single 64 bit word
+        static constexpr blt::i32 max_solver_board_size = 63;
+        // boards this size or smaller are almost always solved faster exactly than by the genetic algorithm
+        static constexpr blt::i32 fast_path_board_size = 7;
+
+        explicit backtracking_solver_t(problem_t problem);
+
+        // finds a board with fitness zero. a node_limit of zero means unlimited
+        [[nodiscard]] blt::expected<solution_t, error_t> solve(blt::u64 node_limit = 0);
+
+        // search nodes (cell assignments) visited by the last solve
+        [[nodiscard]] blt::u64 get_nodes_visited() const
+        {
+            return nodes_visited;
+        }
+
+    private:
+        bool search();
+
+        // checks the clues of a line given as a pointer and stride, 0 marks an open cell
+        [[nodiscard]] bool line_feasible(const cell_t* line, blt::i32 stride, blt::i32 first_clue, blt::i32 last_clue) const;
+
+        [[nodiscard]] blt::u64 candidates(blt::size_t index) const;
+
+        problem_t m_problem;
+        std::vector<cell_t> board;
+        // candidate values from constraint propagation, bit v set means v is allowed
+        std::vector<blt::u64> domains;
+        std::vector<blt::u64> row_used, column_used;
+        blt::i32 open_cells = 0;
+        blt::u64 nodes_visited = 0;
+        blt::u64 node_limit = 0;
+        bool limit_reached = false;
+    };
+}
+
+#endif //SOLVER_H
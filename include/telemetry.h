@@ -0,0 +1,139 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <blt/std/types.h>
+
+namespace sky
+{
+    // counters of a single generation. written as is to binary traces, so only fixed width fields
+    struct generation_record_t
+    {
+        blt::u64 generation;
+        // children built and scored
+        blt::u64 evaluations;
+        // nanoseconds spent in each phase, summed over every worker
+        blt::u64 select_ns;
+        blt::u64 crossover_ns;
+        blt::u64 mutate_ns;
+        blt::u64 evaluate_ns;
+        double average_fitness;
+        double diversity;
+        blt::i32 best_fitness;
+        blt::u32 reserved;
+    };
+
+    static_assert(std::is_trivially_copyable_v<generation_record_t>);
+
+    // single producer / single consumer queue of generation records, never allocates after construction.
+    // records pushed while the ring is full are dropped and counted rather than blocking the run
+    class telemetry_ring_t
+    {
+    public:
+        // capacity is rounded up to a power of two
+        explicit telemetry_ring_t(blt::size_t capacity = 4096);
+
+        bool push(const generation_record_t& record)
+        {
+            const auto head = write_index.load(std::memory_order_relaxed);
+            if (head - read_index.load(std::memory_order_acquire) == records.size())
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            records[head & mask] = record;
+            write_index.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool pop(generation_record_t& record)
+        {
+            const auto tail = read_index.load(std::memory_order_relaxed);
+            if (tail == write_index.load(std::memory_order_acquire))
+                return false;
+            record = records[tail & mask];
+            read_index.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        [[nodiscard]] blt::u64 get_dropped() const
+        {
+            return dropped.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::vector<generation_record_t> records;
+        blt::size_t mask;
+        alignas(64) std::atomic<blt::u64> write_index = 0;
+        alignas(64) std::atomic<blt::u64> read_index = 0;
+        std::atomic<blt::u64> dropped = 0;
+    };
+
+    enum class telemetry_format_t
+    {
+        // one header line then one line per generation
+        CSV,
+        // "SKYT" magic, u32 version, u32 record size, then raw generation_record_t
+        BINARY
+    };
+
+    // background thread draining a ring into a file every interval, and once more when destroyed
+    class telemetry_sink_t
+    {
+    public:
+        telemetry_sink_t(telemetry_ring_t& ring, std::string_view path, telemetry_format_t format,
+                         std::chrono::milliseconds interval = std::chrono::milliseconds(100));
+
+        telemetry_sink_t(const telemetry_sink_t&) = delete;
+        telemetry_sink_t& operator=(const telemetry_sink_t&) = delete;
+
+        ~telemetry_sink_t();
+
+        [[nodiscard]] bool is_open() const
+        {
+            return static_cast<bool>(file);
+        }
+
+    private:
+        void drain();
+
+        void loop();
+
+        telemetry_ring_t& ring;
+        telemetry_format_t format;
+        std::chrono::milliseconds interval;
+        std::ofstream file;
+        std::mutex mutex;
+        std::condition_variable wake;
+        bool stopping = false;
+        std::thread thread;
+    };
+}
+
+#endif //TELEMETRY_H
@@ -0,0 +1,77 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <blt/std/types.h>
+
+namespace sky
+{
+    // a fixed set of threads which all run the same job, each with its own task index. the calling thread takes task 0.
+    // threads are created once, dispatching a job never allocates
+    class worker_pool_t
+    {
+    public:
+        explicit worker_pool_t(blt::size_t task_count);
+
+        worker_pool_t(const worker_pool_t&) = delete;
+        worker_pool_t& operator=(const worker_pool_t&) = delete;
+
+        ~worker_pool_t();
+
+        // number of tasks each job is split into, including the calling thread
+        [[nodiscard]] blt::size_t size() const
+        {
+            return threads.size() + 1;
+        }
+
+        // calls func(task) for every task in [0, size()) and blocks until all of them return
+        template <typename Func>
+        void run(Func& func)
+        {
+            dispatch(&invoke<Func>, &func);
+        }
+
+    private:
+        template <typename Func>
+        static void invoke(void* func, const blt::size_t task)
+        {
+            (*static_cast<Func*>(func))(task);
+        }
+
+        void dispatch(void (*job)(void*, blt::size_t), void* context);
+
+        void worker_loop(blt::size_t task);
+
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::condition_variable start_condition, done_condition;
+        void (*job)(void*, blt::size_t) = nullptr;
+        void* context = nullptr;
+        blt::u64 generation = 0;
+        blt::size_t running = 0;
+        bool stopping = false;
+    };
+}
+
+#endif //WORKER_POOL_H
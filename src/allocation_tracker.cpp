@@ -0,0 +1,97 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <allocation_tracker.h>
+
+#ifdef SKYSCRAPERS_GA_TRACK_ALLOCATIONS
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<blt::u64> allocation_count{0};
+    std::atomic<blt::u64> allocation_bytes{0};
+
+    void record(const std::size_t size)
+    {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+        allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+}
+
+// the nothrow, array and sized forms all forward to these by default
+void* operator new(const std::size_t size)
+{
+    record(size);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc{};
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment)
+{
+    record(size);
+    const auto align = static_cast<std::size_t>(alignment);
+    // aligned_alloc requires a non zero size that is a multiple of the alignment
+    const auto rounded = size == 0 ? align : (size + align - 1) / align * align;
+    if (void* ptr = std::aligned_alloc(align, rounded))
+        return ptr;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+#endif
+
+namespace sky::allocations
+{
+    blt::u64 count()
+    {
+#ifdef SKYSCRAPERS_GA_TRACK_ALLOCATIONS
+        return allocation_count.load(std::memory_order_relaxed);
+#else
+        return 0;
+#endif
+    }
+
+    blt::u64 bytes()
+    {
+#ifdef SKYSCRAPERS_GA_TRACK_ALLOCATIONS
+        return allocation_bytes.load(std::memory_order_relaxed);
+#else
+        return 0;
+#endif
+    }
+}
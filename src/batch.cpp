@@ -0,0 +1,303 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <batch.h>
+#include <solver.h>
+#include <blt/fs/loader.h>
+#include <blt/std/logging.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace sky
+{
+    namespace
+    {
+        using clock_type = std::chrono::steady_clock;
+
+        // each worker owns a queue, taking jobs from its front and stealing from the back of the others once it runs dry
+        struct job_queue_t
+        {
+            std::mutex mutex;
+            std::deque<blt::size_t> jobs;
+        };
+
+        bool next_job(std::vector<std::unique_ptr<job_queue_t>>& queues, const blt::size_t worker, blt::size_t& job)
+        {
+            {
+                auto& own = *queues[worker];
+                std::scoped_lock lock{own.mutex};
+                if (!own.jobs.empty())
+                {
+                    job = own.jobs.front();
+                    own.jobs.pop_front();
+                    return true;
+                }
+            }
+            for (blt::size_t offset = 1; offset < queues.size(); offset++)
+            {
+                auto& victim = *queues[(worker + offset) % queues.size()];
+                std::scoped_lock lock{victim.mutex};
+                if (!victim.jobs.empty())
+                {
+                    job = victim.jobs.back();
+                    victim.jobs.pop_back();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void write_json_string(std::ostream& out, const std::string_view str)
+        {
+            out << '"';
+            for (const char c : str)
+            {
+                if (c == '"' || c == '\\')
+                    out << '\\' << c;
+                else if (static_cast<unsigned char>(c) < 0x20)
+                    out << ' ';
+                else
+                    out << c;
+            }
+            out << '"';
+        }
+
+        batch_config_t job_config(const batch_config_t& config, const blt::size_t job)
+        {
+            auto copy = config;
+            copy.seed = rng::stream(config.seed, job);
+            return copy;
+        }
+
+        // solves jobs [0, job_count) on the configured number of workers. solve(job, problem) produces the result of a job, problem is
+        // scratch storage owned by the calling worker. a job that throws is reported under name(job) with an error, the rest keep going
+        template <typename Name, typename Solve>
+        blt::size_t run_jobs(const blt::size_t job_count, const batch_config_t& config, std::ostream& out, const Name& name, const Solve& solve)
+        {
+            auto worker_count = config.workers == 0 ? static_cast<blt::size_t>(std::thread::hardware_concurrency()) : config.workers;
+            worker_count = std::max<blt::size_t>(1, std::min(worker_count, job_count));
+
+            std::vector<std::unique_ptr<job_queue_t>> queues;
+            for (blt::size_t i = 0; i < worker_count; i++)
+                queues.push_back(std::make_unique<job_queue_t>());
+            for (blt::size_t job = 0; job < job_count; job++)
+                queues[job % worker_count]->jobs.push_back(job);
+
+            std::mutex output_mutex;
+            std::atomic<blt::size_t> solved = 0;
+
+            const auto work = [&](const blt::size_t worker)
+            {
+                problem_t problem{0};
+                blt::size_t job;
+                while (next_job(queues, worker, job))
+                {
+                    batch_result_t result;
+                    try
+                    {
+                        result = solve(job, problem);
+                    } catch (const std::exception& e)
+                    {
+                        result.file = name(job);
+                        result.error = e.what();
+                    }
+                    if (result.fitness == 0)
+                        solved.fetch_add(1, std::memory_order_relaxed);
+                    std::scoped_lock lock{output_mutex};
+                    write_batch_result(out, result);
+                    out << '\n';
+                    out.flush();
+                }
+            };
+
+            std::vector<std::thread> threads;
+            for (blt::size_t worker = 1; worker < worker_count; worker++)
+                threads.emplace_back(work, worker);
+            work(0);
+            for (auto& thread : threads)
+                thread.join();
+
+            return solved.load();
+        }
+    }
+
+    std::vector<std::string> collect_batch_files(const std::string_view path)
+    {
+        namespace fs = std::filesystem;
+        std::vector<std::string> files;
+        const fs::path root{std::string(path)};
+
+        std::error_code error;
+        if (fs::is_directory(root, error))
+        {
+            for (const auto& entry : fs::directory_iterator(root, error))
+            {
+                if (entry.is_regular_file())
+                    files.push_back(entry.path().string());
+            }
+            std::sort(files.begin(), files.end());
+            return files;
+        }
+
+        if (!fs::exists(root, error))
+        {
+            BLT_WARN("Batch input '%s' does not exist", root.string().c_str());
+            return files;
+        }
+
+        for (auto& line : blt::fs::getLinesFromFile(path))
+        {
+            while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back())))
+                line.pop_back();
+            if (line.empty() || line.front() == '#')
+                continue;
+            const fs::path entry{line};
+            files.push_back(entry.is_absolute() ? entry.string() : (root.parent_path() / entry).string());
+        }
+        return files;
+    }
+
+    batch_result_t solve_batch_job(const std::string& file, const batch_config_t& config)
+    {
+        const auto start = clock_type::now();
+        auto problem = problem_from_file(file);
+        if (!problem)
+        {
+            batch_result_t result;
+            result.file = file;
+            result.error = "unable to parse puzzle";
+            result.seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+            return result;
+        }
+        auto result = solve_batch_problem(file, problem.value(), config);
+        result.seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+        return result;
+    }
+
+    batch_result_t solve_batch_problem(std::string name, const problem_t& problem_d, const batch_config_t& config)
+    {
+        const auto start = clock_type::now();
+        const auto elapsed = [start]()
+        {
+            return std::chrono::duration<double>(clock_type::now() - start).count();
+        };
+
+        batch_result_t result;
+        result.file = std::move(name);
+
+        if (config.exact_fast_path && problem_d.board_size <= backtracking_solver_t::fast_path_board_size)
+        {
+            backtracking_solver_t solver{problem_d};
+            if (auto exact = solver.solve(config.exact_node_limit))
+            {
+                result.fitness = exact.value().fitness(problem_d);
+                result.solution = std::move(exact.value());
+                result.exact = true;
+                result.seconds = elapsed();
+                return result;
+            }
+            else if (exact.error() == backtracking_solver_t::error_t::NO_SOLUTION)
+            {
+                result.error = "puzzle has no solution";
+                result.seconds = elapsed();
+                return result;
+            }
+        }
+
+        genetic_algorithm ga{problem_d, config.individual_count, config.crossover_rate, config.mutation_rate, config.seed};
+        ga.set_encoding(config.encoding);
+        ga.set_replacement(config.replacement);
+        ga.set_steady_state(config.steady);
+        ga.set_evaluation(config.evaluation);
+        // the exact attempt already spent part of the time limit, a limit of zero would mean none at all so it never quite reaches zero
+        auto control = config.control;
+        if (control.time_limit_seconds > 0)
+            control.time_limit_seconds = std::max(control.time_limit_seconds - elapsed(), std::numeric_limits<double>::min());
+        run_controller_t controller{control};
+        result.generations = controller.run(ga, config.elites, config.k).generations;
+
+        auto best = ga.get_best(1);
+        result.fitness = best.front().fitness;
+        result.solution = std::move(best.front().solution);
+        result.seconds = elapsed();
+        return result;
+    }
+
+    void write_batch_result(std::ostream& out, const batch_result_t& result)
+    {
+        out << "{\"file\":";
+        write_json_string(out, result.file);
+        if (!result.error.empty())
+        {
+            out << ",\"error\":";
+            write_json_string(out, result.error);
+        }
+        out << ",\"solved\":" << (result.fitness == 0 ? "true" : "false");
+        out << ",\"fitness\":" << result.fitness;
+        out << ",\"generations\":" << result.generations;
+        out << ",\"seconds\":" << result.seconds;
+        out << ",\"method\":" << (result.exact ? "\"exact\"" : "\"ga\"");
+        if (result.solution)
+        {
+            const auto& solution = *result.solution;
+            out << ",\"solution\":[";
+            for (blt::i32 row = 0; row < solution.board_size; row++)
+            {
+                out << (row == 0 ? "[" : ",[");
+                for (blt::i32 column = 0; column < solution.board_size; column++)
+                    out << (column == 0 ? "" : ",") << solution.get(row, column);
+                out << ']';
+            }
+            out << ']';
+        }
+        out << '}';
+    }
+
+    blt::size_t run_batch(const std::vector<std::string>& files, const batch_config_t& config, std::ostream& out)
+    {
+        const auto name = [&files](const blt::size_t job)
+        {
+            return files[job];
+        };
+        return run_jobs(files.size(), config, out, name, [&files, &config](const blt::size_t job, problem_t&)
+        {
+            return solve_batch_job(files[job], job_config(config, job));
+        });
+    }
+
+    blt::size_t run_batch(const corpus_t& corpus, const std::string& name, const batch_config_t& config, std::ostream& out)
+    {
+        const auto job_name = [&name](const blt::size_t job)
+        {
+            return name + "#" + std::to_string(job);
+        };
+        return run_jobs(corpus.size(), config, out, job_name, [&corpus, &job_name, &config](const blt::size_t job, problem_t& problem)
+        {
+            corpus[job].fill(problem);
+            return solve_batch_problem(job_name(job), problem, job_config(config, job));
+        });
+    }
+}
@@ -0,0 +1,291 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <checkpoint.h>
+#include <genetic_algorithm.h>
+#include <blt/std/logging.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sky
+{
+    namespace
+    {
+        blt::u64 align_offset(const blt::u64 offset)
+        {
+            return (offset + 7) & ~blt::u64{7};
+        }
+
+        // the header's enums are cast straight back on resume, so a value past the last enumerator means the file is corrupt
+        template <typename T>
+        bool valid_enum(const blt::u32 value, const T last)
+        {
+            return value <= static_cast<blt::u32>(last);
+        }
+
+        bool valid_enums(const checkpoint_header_t& header)
+        {
+            return valid_enum(header.kernel, fitness_kernel_t::FIXED) && valid_enum(header.selection, selection_t::STOCHASTIC_UNIVERSAL) &&
+                valid_enum(header.local_search_mode, local_search_t::TABU) && valid_enum(header.duplicate_policy, duplicate_policy_t::REPLACE) &&
+                valid_enum(header.encoding, encoding_t::ROW_PERMUTATION) &&
+                valid_enum(header.replacement_mode, replacement_t::FITNESS_SHARING) &&
+                valid_enum(header.steady_victim, steady_victim_t::TOURNAMENT_LOSER) && valid_enum(header.evaluation, evaluation_t::BATCHED);
+        }
+    }
+
+    blt::expected<checkpoint_t, checkpoint_t::error_t> checkpoint_t::open(const std::string_view path)
+    {
+        const std::string file{path};
+        const int fd = ::open(file.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            BLT_WARN("Unable to open checkpoint '%s'", file.c_str());
+            return blt::unexpected(error_t::UNABLE_TO_OPEN);
+        }
+
+        struct stat info{};
+        if (fstat(fd, &info) != 0 || static_cast<blt::size_t>(info.st_size) < sizeof(checkpoint_header_t))
+        {
+            ::close(fd);
+            BLT_WARN("Checkpoint '%s' is too small to hold a header", file.c_str());
+            return blt::unexpected(error_t::TRUNCATED);
+        }
+
+        const auto size = static_cast<blt::size_t>(info.st_size);
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        // the mapping keeps the file alive on its own
+        ::close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            BLT_WARN("Unable to map checkpoint '%s'", file.c_str());
+            return blt::unexpected(error_t::UNABLE_TO_OPEN);
+        }
+
+        checkpoint_t checkpoint{static_cast<const unsigned char*>(mapping), size};
+        const auto& header = checkpoint.header();
+        if (std::memcmp(header.magic, checkpoint_header_t::expected_magic, sizeof(header.magic)) != 0)
+        {
+            BLT_WARN("'%s' is not a checkpoint", file.c_str());
+            return blt::unexpected(error_t::BAD_MAGIC);
+        }
+        if (header.version != checkpoint_header_t::current_version)
+        {
+            BLT_WARN("Checkpoint '%s' has version %u, expected %u", file.c_str(), header.version, checkpoint_header_t::current_version);
+            return blt::unexpected(error_t::UNSUPPORTED_VERSION);
+        }
+        const auto board_size = static_cast<blt::u64>(header.board_size);
+        if (header.board_size <= 0 || header.board_size > max_board_size || header.file_size != size ||
+            header.fitness_offset + header.individual_count * sizeof(blt::i32) > size ||
+            header.scores_offset + header.individual_count * board_size * 2 * sizeof(blt::i32) > size ||
+            header.cells_offset + header.individual_count * board_size * board_size > size ||
+            header.clues_offset + board_size * 4 * sizeof(blt::i32) > size)
+        {
+            BLT_WARN("Checkpoint '%s' is truncated or corrupt", file.c_str());
+            return blt::unexpected(error_t::TRUNCATED);
+        }
+        if (!valid_enums(header))
+        {
+            BLT_WARN("Checkpoint '%s' holds an unknown setting and is corrupt", file.c_str());
+            return blt::unexpected(error_t::TRUNCATED);
+        }
+        return checkpoint;
+    }
+
+    checkpoint_t::checkpoint_t(checkpoint_t&& move) noexcept: data(move.data), size(move.size)
+    {
+        move.data = nullptr;
+        move.size = 0;
+    }
+
+    checkpoint_t& checkpoint_t::operator=(checkpoint_t&& move) noexcept
+    {
+        std::swap(data, move.data);
+        std::swap(size, move.size);
+        return *this;
+    }
+
+    checkpoint_t::~checkpoint_t()
+    {
+        if (data != nullptr)
+            munmap(const_cast<unsigned char*>(data), size);
+    }
+
+    problem_t checkpoint_t::problem() const
+    {
+        const auto board_size = header().board_size;
+        const auto* clues = reinterpret_cast<const blt::i32*>(data + header().clues_offset);
+        problem_t problem{board_size};
+        problem.top.assign(clues, clues + board_size);
+        problem.bottom.assign(clues + board_size, clues + board_size * 2);
+        problem.left.assign(clues + board_size * 2, clues + board_size * 3);
+        problem.right.assign(clues + board_size * 3, clues + board_size * 4);
+        return problem;
+    }
+
+    void write_checkpoint(const genetic_algorithm& ga, std::vector<unsigned char>& buffer)
+    {
+        const auto& problem = ga.get_problem();
+        const auto& population = ga.get_population();
+        const auto board_size = static_cast<blt::u64>(problem.board_size);
+        const auto count = static_cast<blt::u64>(population.size());
+
+        checkpoint_header_t header{};
+        std::memcpy(header.magic, checkpoint_header_t::expected_magic, sizeof(header.magic));
+        header.version = checkpoint_header_t::current_version;
+        header.board_size = problem.board_size;
+        header.individual_count = count;
+        header.generation = ga.get_generation();
+        header.run_seed = ga.get_seed();
+        header.crossover_rate = ga.get_crossover_rate();
+        header.mutation_rate = ga.get_mutation_rate();
+        header.selection_pressure = ga.get_selection_pressure();
+        header.kernel = static_cast<blt::u32>(ga.get_fitness_kernel());
+        header.evaluation = static_cast<blt::u32>(ga.get_evaluation());
+        header.selection = static_cast<blt::u32>(ga.get_selection());
+        header.local_search_mode = static_cast<blt::u32>(ga.get_local_search().mode);
+        header.duplicate_policy = static_cast<blt::u32>(ga.get_duplicate_policy());
+        header.local_search_elites = ga.get_local_search().elites;
+        header.local_search_max_moves = ga.get_local_search().max_moves;
+        header.local_search_tabu_tenure = ga.get_local_search().tabu_tenure;
+        header.encoding = static_cast<blt::u32>(ga.get_encoding());
+        header.max_row_entries = ga.get_row_tables().get_max_row_entries();
+        header.replacement_mode = static_cast<blt::u32>(ga.get_replacement().mode);
+        header.replacement_neighbourhood = ga.get_replacement().neighbourhood;
+        header.sharing_radius = ga.get_replacement().sharing_radius;
+        header.steady_births = ga.get_steady_state().births;
+        header.steady_victim = static_cast<blt::u32>(ga.get_steady_state().victim);
+        header.cache_entries = ga.get_fitness_cache().get_capacity();
+        header.clues_offset = align_offset(sizeof(checkpoint_header_t));
+        header.cells_offset = align_offset(header.clues_offset + board_size * 4 * sizeof(blt::i32));
+        header.scores_offset = align_offset(header.cells_offset + count * board_size * board_size);
+        header.fitness_offset = align_offset(header.scores_offset + count * board_size * 2 * sizeof(blt::i32));
+        header.file_size = header.fitness_offset + count * sizeof(blt::i32);
+
+        buffer.assign(header.file_size, 0);
+        std::memcpy(buffer.data(), &header, sizeof(header));
+
+        auto* clues = buffer.data() + header.clues_offset;
+        for (const auto* side : {&problem.top, &problem.bottom, &problem.left, &problem.right})
+        {
+            std::memcpy(clues, side->data(), board_size * sizeof(blt::i32));
+            clues += board_size * sizeof(blt::i32);
+        }
+        for (blt::u64 i = 0; i < count; i++)
+        {
+            std::memcpy(buffer.data() + header.cells_offset + i * board_size * board_size, population.cells(i), board_size * board_size);
+            std::memcpy(buffer.data() + header.scores_offset + i * board_size * 2 * sizeof(blt::i32), population.line_scores(i),
+                        board_size * 2 * sizeof(blt::i32));
+        }
+        std::memcpy(buffer.data() + header.fitness_offset, population.fitness_values().data(), count * sizeof(blt::i32));
+    }
+
+    namespace
+    {
+        bool write_file(const std::string& path, const std::vector<unsigned char>& buffer)
+        {
+            const auto temporary = path + ".tmp";
+            {
+                std::ofstream file{temporary, std::ios::binary | std::ios::trunc};
+                file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+                if (!file)
+                {
+                    BLT_WARN("Unable to write checkpoint '%s'", temporary.c_str());
+                    return false;
+                }
+            }
+            if (std::rename(temporary.c_str(), path.c_str()) != 0)
+            {
+                BLT_WARN("Unable to move checkpoint into place at '%s'", path.c_str());
+                return false;
+            }
+            return true;
+        }
+    }
+
+    bool save_checkpoint(const std::string_view path, const genetic_algorithm& ga)
+    {
+        std::vector<unsigned char> buffer;
+        write_checkpoint(ga, buffer);
+        return write_file(std::string(path), buffer);
+    }
+
+    checkpoint_writer_t::checkpoint_writer_t(std::string path): path(std::move(path))
+    {
+        thread = std::thread([this]()
+        {
+            loop();
+        });
+    }
+
+    checkpoint_writer_t::~checkpoint_writer_t()
+    {
+        {
+            std::scoped_lock lock{mutex};
+            stopping = true;
+        }
+        wake.notify_one();
+        thread.join();
+    }
+
+    void checkpoint_writer_t::save(const genetic_algorithm& ga)
+    {
+        write_checkpoint(ga, staging);
+        {
+            std::scoped_lock lock{mutex};
+            std::swap(staging, pending);
+            has_pending = true;
+        }
+        wake.notify_one();
+    }
+
+    void checkpoint_writer_t::wait()
+    {
+        std::unique_lock lock{mutex};
+        idle.wait(lock, [this]()
+        {
+            return !has_pending && !busy;
+        });
+    }
+
+    void checkpoint_writer_t::loop()
+    {
+        std::unique_lock lock{mutex};
+        while (true)
+        {
+            wake.wait(lock, [this]()
+            {
+                return stopping || has_pending;
+            });
+            if (!has_pending)
+                return;
+
+            std::swap(pending, writing);
+            has_pending = false;
+            busy = true;
+            lock.unlock();
+            (void) write_file(path, writing);
+            lock.lock();
+            busy = false;
+            idle.notify_all();
+        }
+    }
+}
@@ -0,0 +1,252 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <corpus.h>
+#include <blt/std/logging.h>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sky
+{
+    namespace
+    {
+        blt::u64 record_size(const blt::u64 board_size, const blt::u8 flags)
+        {
+            return 2 + board_size * 4 + ((flags & puzzle_view_t::has_solution_flag) ? board_size * board_size : 0);
+        }
+    }
+
+    void puzzle_view_t::fill(problem_t& problem) const
+    {
+        problem.board_size = board_size;
+        problem.clear_domains();
+        problem.top.assign(top(), top() + board_size);
+        problem.bottom.assign(bottom(), bottom() + board_size);
+        problem.left.assign(left(), left() + board_size);
+        problem.right.assign(right(), right() + board_size);
+    }
+
+    problem_t puzzle_view_t::to_problem() const
+    {
+        problem_t problem{board_size};
+        fill(problem);
+        return problem;
+    }
+
+    solution_t puzzle_view_t::to_solution() const
+    {
+        solution_t result{board_size};
+        std::memcpy(result.board_data.data(), solution, result.board_data.size());
+        return result;
+    }
+
+    blt::expected<corpus_t, corpus_t::error_t> corpus_t::open(const std::string_view path)
+    {
+        const std::string file{path};
+        const int fd = ::open(file.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            BLT_WARN("Unable to open corpus '%s'", file.c_str());
+            return blt::unexpected(error_t::UNABLE_TO_OPEN);
+        }
+
+        struct stat info{};
+        if (fstat(fd, &info) != 0 || static_cast<blt::size_t>(info.st_size) < sizeof(corpus_header_t))
+        {
+            ::close(fd);
+            BLT_WARN("Corpus '%s' is too small to hold a header", file.c_str());
+            return blt::unexpected(error_t::TRUNCATED);
+        }
+
+        const auto size = static_cast<blt::size_t>(info.st_size);
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            BLT_WARN("Unable to map corpus '%s'", file.c_str());
+            return blt::unexpected(error_t::UNABLE_TO_OPEN);
+        }
+        // puzzles are usually read front to back by the batch workers
+        madvise(mapping, size, MADV_SEQUENTIAL);
+
+        corpus_t corpus{static_cast<const unsigned char*>(mapping), size};
+        const auto& header = corpus.header();
+        if (std::memcmp(header.magic, corpus_header_t::expected_magic, sizeof(header.magic)) != 0)
+        {
+            BLT_WARN("'%s' is not a puzzle corpus", file.c_str());
+            return blt::unexpected(error_t::BAD_MAGIC);
+        }
+        if (header.version != corpus_header_t::current_version)
+        {
+            BLT_WARN("Corpus '%s' has version %u, expected %u", file.c_str(), header.version, corpus_header_t::current_version);
+            return blt::unexpected(error_t::UNSUPPORTED_VERSION);
+        }
+        if (header.file_size != size || header.index_offset % alignof(blt::u64) != 0 || header.index_offset < sizeof(corpus_header_t) ||
+            header.index_offset > size || header.puzzle_count > (size - header.index_offset) / sizeof(blt::u64))
+        {
+            BLT_WARN("Corpus '%s' is truncated or corrupt", file.c_str());
+            return blt::unexpected(error_t::TRUNCATED);
+        }
+        const auto* offsets = corpus.index();
+        for (blt::u64 i = 0; i < header.puzzle_count; i++)
+        {
+            const auto offset = offsets[i];
+            // written so no sum can wrap, a corrupt offset can be anywhere up to 2^64
+            if (offset > size - 2 || corpus.data[offset] == 0 || record_size(corpus.data[offset], corpus.data[offset + 1]) > size - offset)
+            {
+                BLT_WARN("Corpus '%s' is truncated or corrupt at puzzle %lu", file.c_str(), static_cast<unsigned long>(i));
+                return blt::unexpected(error_t::TRUNCATED);
+            }
+        }
+        return corpus;
+    }
+
+    bool corpus_t::is_corpus(const std::string_view path)
+    {
+        std::ifstream file{std::string(path), std::ios::binary};
+        char magic[sizeof(corpus_header_t::expected_magic)]{};
+        file.read(magic, sizeof(magic));
+        return file && std::memcmp(magic, corpus_header_t::expected_magic, sizeof(magic)) == 0;
+    }
+
+    corpus_t::corpus_t(corpus_t&& move) noexcept: data(move.data), map_size(move.map_size)
+    {
+        move.data = nullptr;
+        move.map_size = 0;
+    }
+
+    corpus_t& corpus_t::operator=(corpus_t&& move) noexcept
+    {
+        std::swap(data, move.data);
+        std::swap(map_size, move.map_size);
+        return *this;
+    }
+
+    corpus_t::~corpus_t()
+    {
+        if (data != nullptr)
+            munmap(const_cast<unsigned char*>(data), map_size);
+    }
+
+    puzzle_view_t corpus_t::operator[](const blt::size_t index) const
+    {
+        const auto* record = data + this->index()[index];
+        puzzle_view_t view;
+        view.board_size = record[0];
+        view.clues = record + 2;
+        if (record[1] & puzzle_view_t::has_solution_flag)
+            view.solution = view.clues + view.board_size * 4;
+        return view;
+    }
+
+    bool write_corpus(const std::string_view path, const std::vector<problem_t>& problems, const std::vector<const solution_t*>& solutions)
+    {
+        const std::string file{path};
+        const auto has_solution = [&solutions](const blt::size_t i)
+        {
+            return i < solutions.size() && solutions[i] != nullptr;
+        };
+
+        corpus_header_t header{};
+        std::memcpy(header.magic, corpus_header_t::expected_magic, sizeof(header.magic));
+        header.version = corpus_header_t::current_version;
+        header.puzzle_count = problems.size();
+        header.index_offset = sizeof(corpus_header_t);
+
+        std::vector<blt::u64> offsets;
+        offsets.reserve(problems.size());
+        auto offset = header.index_offset + problems.size() * sizeof(blt::u64);
+        for (blt::size_t i = 0; i < problems.size(); i++)
+        {
+            const auto board_size = problems[i].board_size;
+            if (board_size <= 0 || board_size > max_board_size)
+            {
+                BLT_WARN("Puzzle %lu of size %d can not be stored in a corpus", static_cast<unsigned long>(i), board_size);
+                return false;
+            }
+            offsets.push_back(offset);
+            offset += record_size(board_size, has_solution(i) ? puzzle_view_t::has_solution_flag : 0);
+        }
+        header.file_size = offset;
+
+        std::vector<unsigned char> buffer;
+        buffer.reserve(header.file_size);
+        buffer.resize(sizeof(header));
+        std::memcpy(buffer.data(), &header, sizeof(header));
+        buffer.resize(header.index_offset + offsets.size() * sizeof(blt::u64));
+        std::memcpy(buffer.data() + header.index_offset, offsets.data(), offsets.size() * sizeof(blt::u64));
+
+        for (blt::size_t i = 0; i < problems.size(); i++)
+        {
+            const auto& problem = problems[i];
+            buffer.push_back(static_cast<unsigned char>(problem.board_size));
+            buffer.push_back(has_solution(i) ? puzzle_view_t::has_solution_flag : 0);
+            for (const auto* side : {&problem.top, &problem.bottom, &problem.left, &problem.right})
+            {
+                for (blt::i32 j = 0; j < problem.board_size; j++)
+                {
+                    const auto clue = j < static_cast<blt::i32>(side->size()) ? (*side)[j] : 0;
+                    buffer.push_back(static_cast<unsigned char>(std::clamp(clue, 0, problem.board_size)));
+                }
+            }
+            if (has_solution(i))
+                buffer.insert(buffer.end(), solutions[i]->board_data.begin(), solutions[i]->board_data.end());
+        }
+
+        std::ofstream out{file, std::ios::binary | std::ios::trunc};
+        out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        if (!out)
+        {
+            BLT_WARN("Unable to write corpus '%s'", file.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    blt::i64 pack_corpus(const std::string_view path, const std::vector<std::string>& files)
+    {
+        std::vector<problem_t> problems;
+        std::vector<std::optional<solution_t>> stored_solutions;
+        problems.reserve(files.size());
+        stored_solutions.reserve(files.size());
+        for (const auto& file : files)
+        {
+            auto puzzle = puzzle_from_file(file);
+            if (!puzzle)
+            {
+                BLT_WARN("Skipping '%s', unable to parse it", file.c_str());
+                continue;
+            }
+            problems.push_back(std::move(puzzle->problem));
+            stored_solutions.push_back(std::move(puzzle->solution));
+        }
+
+        std::vector<const solution_t*> solutions;
+        solutions.reserve(stored_solutions.size());
+        for (const auto& solution : stored_solutions)
+            solutions.push_back(solution ? &*solution : nullptr);
+
+        if (!write_corpus(path, problems, solutions))
+            return -1;
+        return static_cast<blt::i64>(problems.size());
+    }
+}
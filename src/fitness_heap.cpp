@@ -0,0 +1,101 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <fitness_heap.h>
+#include <numeric>
+#include <utility>
+
+namespace sky
+{
+    void fitness_heap_t::build(const std::vector<blt::i32>& fitness)
+    {
+        keys = fitness;
+        for (const bool max : {false, true})
+        {
+            auto& side = max ? max_side : min_side;
+            side.heap.resize(keys.size());
+            side.position.resize(keys.size());
+            std::iota(side.heap.begin(), side.heap.end(), 0);
+            std::iota(side.position.begin(), side.position.end(), 0);
+            for (blt::size_t i = keys.size() / 2; i > 0; i--)
+                sift_down(side, max, i - 1);
+        }
+    }
+
+    void fitness_heap_t::update(const blt::size_t index, const blt::i32 fitness)
+    {
+        const auto previous = keys[index];
+        keys[index] = fitness;
+        if (fitness == previous)
+            return;
+        // a lower fitness rises on the min side and sinks on the max side, a higher one the other way round
+        if (fitness < previous)
+        {
+            sift_up(min_side, false, min_side.position[index]);
+            sift_down(max_side, true, max_side.position[index]);
+        }
+        else
+        {
+            sift_down(min_side, false, min_side.position[index]);
+            sift_up(max_side, true, max_side.position[index]);
+        }
+    }
+
+    bool fitness_heap_t::above(const bool max, const blt::size_t a, const blt::size_t b) const
+    {
+        if (keys[a] != keys[b])
+            return max ? keys[a] > keys[b] : keys[a] < keys[b];
+        return max ? a > b : a < b;
+    }
+
+    void fitness_heap_t::sift_up(side_t& side, const bool max, blt::size_t at)
+    {
+        while (at > 0)
+        {
+            const auto parent = (at - 1) / 2;
+            if (!above(max, side.heap[at], side.heap[parent]))
+                return;
+            swap(side, at, parent);
+            at = parent;
+        }
+    }
+
+    void fitness_heap_t::sift_down(side_t& side, const bool max, blt::size_t at)
+    {
+        const auto count = side.heap.size();
+        while (true)
+        {
+            auto top = at;
+            for (const auto child : {at * 2 + 1, at * 2 + 2})
+            {
+                if (child < count && above(max, side.heap[child], side.heap[top]))
+                    top = child;
+            }
+            if (top == at)
+                return;
+            swap(side, at, top);
+            at = top;
+        }
+    }
+
+    void fitness_heap_t::swap(side_t& side, const blt::size_t a, const blt::size_t b)
+    {
+        std::swap(side.heap[a], side.heap[b]);
+        side.position[side.heap[a]] = a;
+        side.position[side.heap[b]] = b;
+    }
+}
@@ -0,0 +1,707 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <fitness_kernel.h>
+#include <fixed_board.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace sky
+{
+    blt::i32 score_row(const problem_t& problem, const cell_t* cells, const blt::i32 row, const fitness_kernel_t kernel)
+    {
+        if (kernel == fitness_kernel_t::FIXED)
+        {
+            if (const auto* fixed = kernel::fixed_kernels(problem.board_size))
+                return fixed->row_score(problem, cells, row);
+        }
+        if (kernel != fitness_kernel_t::REFERENCE)
+            return kernel::bitmask_row_score(problem, cells, row);
+        return kernel::reference_row_incorrect_count(cells, problem.board_size, row) + kernel::reference_row_view_count(problem, cells, row);
+    }
+
+    blt::i32 score_column(const problem_t& problem, const cell_t* cells, const blt::i32 column, const fitness_kernel_t kernel)
+    {
+        if (kernel == fitness_kernel_t::FIXED)
+        {
+            if (const auto* fixed = kernel::fixed_kernels(problem.board_size))
+                return fixed->column_score(problem, cells, column);
+        }
+        if (kernel != fitness_kernel_t::REFERENCE)
+            return kernel::bitmask_column_score(problem, cells, column);
+        return kernel::reference_column_incorrect_count(cells, problem.board_size, column) +
+            kernel::reference_column_view_count(problem, cells, column);
+    }
+
+    blt::i32 score_lines(const problem_t& problem, const cell_t* cells, blt::i32* line_scores, const fitness_kernel_t kernel)
+    {
+        if (kernel == fitness_kernel_t::FIXED)
+        {
+            if (const auto* fixed = kernel::fixed_kernels(problem.board_size))
+                return fixed->line_scores(problem, cells, line_scores);
+        }
+        if (kernel != fitness_kernel_t::REFERENCE)
+            return kernel::bitmask_line_scores(problem, cells, line_scores);
+
+        const auto board_size = problem.board_size;
+        blt::i32 fitness = 0;
+        for (blt::i32 i = 0; i < board_size; i++)
+        {
+            const auto row = score_row(problem, cells, i, kernel);
+            const auto column = score_column(problem, cells, i, kernel);
+            if (line_scores != nullptr)
+            {
+                line_scores[i] = row;
+                line_scores[board_size + i] = column;
+            }
+            fitness += row + column;
+        }
+        return fitness;
+    }
+
+    void rescore_lines(const problem_t& problem, const cell_t* cells, blt::i32* line_scores, blt::i32& fitness, const dirty_lines_t& dirty,
+                       const fitness_kernel_t kernel)
+    {
+        if (kernel == fitness_kernel_t::FIXED)
+        {
+            if (const auto* fixed = kernel::fixed_kernels(problem.board_size))
+            {
+                fixed->rescore_lines(problem, cells, line_scores, fitness, dirty);
+                return;
+            }
+        }
+
+        const auto board_size = problem.board_size;
+        for (blt::i32 i = 0; i < board_size; i++)
+        {
+            if (dirty.rows[i])
+            {
+                fitness -= line_scores[i];
+                line_scores[i] = score_row(problem, cells, i, kernel);
+                fitness += line_scores[i];
+            }
+            if (dirty.columns[i])
+            {
+                fitness -= line_scores[board_size + i];
+                line_scores[board_size + i] = score_column(problem, cells, i, kernel);
+                fitness += line_scores[board_size + i];
+            }
+        }
+    }
+}
+
+namespace sky::kernel
+{
+    blt::i32 reference_row_incorrect_count(const cell_t* cells, const blt::i32 board_size, const blt::i32 row)
+    {
+        thread_local std::vector<blt::i32> value_counts;
+        value_counts.resize(board_size);
+        std::memset(value_counts.data(), 0, sizeof(blt::i32) * board_size);
+
+        for (blt::i32 column = 0; column < board_size; column++)
+            ++value_counts[cells[row * board_size + column] - 1];
+
+        blt::i32 sum = 0;
+        for (const auto v : value_counts)
+            sum += std::abs(v - 1);
+
+        return sum;
+    }
+
+    blt::i32 reference_row_view_count(const problem_t& problem, const cell_t* cells, const blt::i32 row)
+    {
+        const auto board_size = problem.board_size;
+        blt::i32 sees_left = 0;
+        blt::i32 sees_right = 0;
+
+        blt::i32 highest_left = 0;
+        blt::i32 highest_right = 0;
+
+        for (blt::i32 column = 0; column < board_size; column++)
+        {
+            if (cells[row * board_size + column] > highest_left)
+            {
+                ++sees_left;
+                highest_left = cells[row * board_size + column];
+            }
+        }
+
+        for (blt::i32 column = board_size - 1; column >= 0; column--)
+        {
+            if (cells[row * board_size + column] > highest_right)
+            {
+                ++sees_right;
+                highest_right = cells[row * board_size + column];
+            }
+        }
+
+        const auto left = problem.left[row];
+        const auto right = problem.right[row];
+
+        return view_error(left, sees_left) + view_error(right, sees_right);
+    }
+
+    blt::i32 reference_column_view_count(const problem_t& problem, const cell_t* cells, const blt::i32 column)
+    {
+        const auto board_size = problem.board_size;
+        blt::i32 sees_top = 0;
+        blt::i32 sees_bottom = 0;
+
+        blt::i32 highest_top = 0;
+        blt::i32 highest_bottom = 0;
+
+        for (blt::i32 row = 0; row < board_size; row++)
+        {
+            if (cells[row * board_size + column] > highest_top)
+            {
+                ++sees_top;
+                highest_top = cells[row * board_size + column];
+            }
+        }
+
+        for (blt::i32 row = board_size - 1; row >= 0; row--)
+        {
+            if (cells[row * board_size + column] > highest_bottom)
+            {
+                ++sees_bottom;
+                highest_bottom = cells[row * board_size + column];
+            }
+        }
+
+        const auto top = problem.top[column];
+        const auto bottom = problem.bottom[column];
+
+        return view_error(top, sees_top) + view_error(bottom, sees_bottom);
+    }
+
+    blt::i32 reference_column_incorrect_count(const cell_t* cells, const blt::i32 board_size, const blt::i32 column)
+    {
+        thread_local std::vector<blt::i32> value_counts;
+        value_counts.resize(board_size);
+        std::memset(value_counts.data(), 0, sizeof(blt::i32) * board_size);
+
+        for (blt::i32 row = 0; row < board_size; row++)
+            ++value_counts[cells[row * board_size + column] - 1];
+
+        blt::i32 sum = 0;
+        for (const auto v : value_counts)
+            sum += std::abs(v - 1);
+
+        return sum;
+    }
+
+    namespace
+    {
+        // one bit per possible cell value, cell_t caps boards at 255 so four words always suffice
+        struct occupancy_t
+        {
+            blt::u64 words[4]{};
+
+            void add(const blt::i32 value)
+            {
+                const auto bit = static_cast<blt::u32>(value - 1);
+                words[bit >> 6] |= blt::u64{1} << (bit & 63);
+            }
+
+            [[nodiscard]] blt::i32 duplicate_score(const blt::i32 board_size) const
+            {
+                blt::i32 distinct = 0;
+                for (const auto word : words)
+                    distinct += __builtin_popcountll(word);
+                return 2 * (board_size - distinct);
+            }
+        };
+
+        blt::i32 line_score(const cell_t* line, const blt::i32 board_size, const blt::i32 stride, const blt::i32 first_clue,
+                            const blt::i32 last_clue)
+        {
+            occupancy_t occupancy;
+            blt::i32 sees_first = 0;
+            blt::i32 highest_first = 0;
+            for (blt::i32 i = 0; i < board_size; i++)
+            {
+                const blt::i32 value = line[i * stride];
+                occupancy.add(value);
+                sees_first += value > highest_first;
+                highest_first = std::max(highest_first, value);
+            }
+
+            blt::i32 sees_last = 0;
+            blt::i32 highest_last = 0;
+            for (blt::i32 i = board_size - 1; i >= 0; i--)
+            {
+                const blt::i32 value = line[i * stride];
+                sees_last += value > highest_last;
+                highest_last = std::max(highest_last, value);
+            }
+
+            return occupancy.duplicate_score(board_size) + view_error(first_clue, sees_first) + view_error(last_clue, sees_last);
+        }
+
+        // scratch boards are stored with a fixed 32 byte stride so every line is one aligned vector load. lanes past the board size can
+        // hold cells of a larger board scored earlier on the same thread, their counts are never read
+        struct scratch_t
+        {
+            alignas(32) cell_t lines[max_simd_board_size * max_simd_board_size]{};
+        };
+
+        // counts, for every lane, how many buildings are visible scanning the lines front to back and back to front
+        void lane_views(const scratch_t& scratch, const blt::i32 board_size, cell_t* forward, cell_t* backward)
+        {
+#if defined(__AVX2__)
+            __m256i high = _mm256_setzero_si256();
+            __m256i sees = _mm256_setzero_si256();
+            for (blt::i32 i = 0; i < board_size; i++)
+            {
+                const auto v = _mm256_load_si256(reinterpret_cast<const __m256i*>(scratch.lines + i * max_simd_board_size));
+                sees = _mm256_sub_epi8(sees, _mm256_cmpgt_epi8(v, high));
+                high = _mm256_max_epu8(high, v);
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(forward), sees);
+
+            high = _mm256_setzero_si256();
+            sees = _mm256_setzero_si256();
+            for (blt::i32 i = board_size - 1; i >= 0; i--)
+            {
+                const auto v = _mm256_load_si256(reinterpret_cast<const __m256i*>(scratch.lines + i * max_simd_board_size));
+                sees = _mm256_sub_epi8(sees, _mm256_cmpgt_epi8(v, high));
+                high = _mm256_max_epu8(high, v);
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(backward), sees);
+#elif defined(__SSE2__)
+            // values never exceed 32 so the signed byte compare is safe
+            for (blt::i32 lane = 0; lane < board_size; lane += 16)
+            {
+                __m128i high = _mm_setzero_si128();
+                __m128i sees = _mm_setzero_si128();
+                for (blt::i32 i = 0; i < board_size; i++)
+                {
+                    const auto v = _mm_load_si128(reinterpret_cast<const __m128i*>(scratch.lines + i * max_simd_board_size + lane));
+                    sees = _mm_sub_epi8(sees, _mm_cmpgt_epi8(v, high));
+                    high = _mm_max_epu8(high, v);
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(forward + lane), sees);
+
+                high = _mm_setzero_si128();
+                sees = _mm_setzero_si128();
+                for (blt::i32 i = board_size - 1; i >= 0; i--)
+                {
+                    const auto v = _mm_load_si128(reinterpret_cast<const __m128i*>(scratch.lines + i * max_simd_board_size + lane));
+                    sees = _mm_sub_epi8(sees, _mm_cmpgt_epi8(v, high));
+                    high = _mm_max_epu8(high, v);
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(backward + lane), sees);
+            }
+#else
+            for (blt::i32 lane = 0; lane < board_size; lane++)
+            {
+                cell_t high = 0;
+                cell_t sees = 0;
+                for (blt::i32 i = 0; i < board_size; i++)
+                {
+                    const auto v = scratch.lines[i * max_simd_board_size + lane];
+                    sees += v > high;
+                    high = std::max(high, v);
+                }
+                forward[lane] = sees;
+
+                high = 0;
+                sees = 0;
+                for (blt::i32 i = board_size - 1; i >= 0; i--)
+                {
+                    const auto v = scratch.lines[i * max_simd_board_size + lane];
+                    sees += v > high;
+                    high = std::max(high, v);
+                }
+                backward[lane] = sees;
+            }
+#endif
+        }
+
+        blt::i32 simd_line_scores(const problem_t& problem, const cell_t* cells, blt::i32* line_scores)
+        {
+            // by_row holds the board as is, so its lanes are the columns. by_column is the transpose, so its lanes are the rows
+            thread_local scratch_t by_row;
+            thread_local scratch_t by_column;
+            const auto board_size = problem.board_size;
+
+            occupancy_t row_occupancy[max_simd_board_size];
+            occupancy_t column_occupancy[max_simd_board_size];
+            for (blt::i32 row = 0; row < board_size; row++)
+            {
+                for (blt::i32 column = 0; column < board_size; column++)
+                {
+                    const auto value = cells[row * board_size + column];
+                    by_row.lines[row * max_simd_board_size + column] = value;
+                    by_column.lines[column * max_simd_board_size + row] = value;
+                    row_occupancy[row].add(value);
+                    column_occupancy[column].add(value);
+                }
+            }
+
+            alignas(32) cell_t left[max_simd_board_size], right[max_simd_board_size];
+            alignas(32) cell_t top[max_simd_board_size], bottom[max_simd_board_size];
+            lane_views(by_column, board_size, left, right);
+            lane_views(by_row, board_size, top, bottom);
+
+            blt::i32 fitness = 0;
+            for (blt::i32 i = 0; i < board_size; i++)
+            {
+                const auto row = row_occupancy[i].duplicate_score(board_size) + view_error(problem.left[i], left[i]) +
+                    view_error(problem.right[i], right[i]);
+                const auto column = column_occupancy[i].duplicate_score(board_size) + view_error(problem.top[i], top[i]) +
+                    view_error(problem.bottom[i], bottom[i]);
+                if (line_scores != nullptr)
+                {
+                    line_scores[i] = row;
+                    line_scores[board_size + i] = column;
+                }
+                fitness += row + column;
+            }
+            return fitness;
+        }
+    }
+
+    blt::i32 bitmask_row_score(const problem_t& problem, const cell_t* cells, const blt::i32 row)
+    {
+        return line_score(cells + row * problem.board_size, problem.board_size, 1, problem.left[row], problem.right[row]);
+    }
+
+    blt::i32 bitmask_column_score(const problem_t& problem, const cell_t* cells, const blt::i32 column)
+    {
+        return line_score(cells + column, problem.board_size, problem.board_size, problem.top[column], problem.bottom[column]);
+    }
+
+    blt::i32 bitmask_line_scores(const problem_t& problem, const cell_t* cells, blt::i32* line_scores)
+    {
+        if (problem.board_size <= max_simd_board_size)
+            return simd_line_scores(problem, cells, line_scores);
+
+        const auto board_size = problem.board_size;
+        blt::i32 fitness = 0;
+        for (blt::i32 i = 0; i < board_size; i++)
+        {
+            const auto row = bitmask_row_score(problem, cells, i);
+            const auto column = bitmask_column_score(problem, cells, i);
+            if (line_scores != nullptr)
+            {
+                line_scores[i] = row;
+                line_scores[board_size + i] = column;
+            }
+            fitness += row + column;
+        }
+        return fitness;
+    }
+}
+
+namespace sky::kernel
+{
+    namespace
+    {
+        // a byte per board of the batch. values never exceed 32 so the signed byte compare is safe
+        struct lanes_t
+        {
+#if defined(__AVX2__)
+            __m256i v;
+#elif defined(__SSE2__)
+            __m128i lo, hi;
+#else
+            blt::u8 v[batch_lanes];
+#endif
+        };
+
+#if defined(__AVX2__)
+        void store(blt::u8* to, const lanes_t a)
+        {
+            _mm256_store_si256(reinterpret_cast<__m256i*>(to), a.v);
+        }
+
+        lanes_t splat(const blt::u8 value)
+        {
+            return {_mm256_set1_epi8(static_cast<char>(value))};
+        }
+
+        lanes_t add(const lanes_t a, const lanes_t b)
+        {
+            return {_mm256_add_epi8(a.v, b.v)};
+        }
+
+        lanes_t sub(const lanes_t a, const lanes_t b)
+        {
+            return {_mm256_sub_epi8(a.v, b.v)};
+        }
+
+        lanes_t max(const lanes_t a, const lanes_t b)
+        {
+            return {_mm256_max_epu8(a.v, b.v)};
+        }
+
+        lanes_t either(const lanes_t a, const lanes_t b)
+        {
+            return {_mm256_or_si256(a.v, b.v)};
+        }
+
+        // all ones in the lanes where the comparison holds
+        lanes_t greater(const lanes_t a, const lanes_t b)
+        {
+            return {_mm256_cmpgt_epi8(a.v, b.v)};
+        }
+
+        lanes_t equal(const lanes_t a, const lanes_t b)
+        {
+            return {_mm256_cmpeq_epi8(a.v, b.v)};
+        }
+#elif defined(__SSE2__)
+        void store(blt::u8* to, const lanes_t a)
+        {
+            _mm_store_si128(reinterpret_cast<__m128i*>(to), a.lo);
+            _mm_store_si128(reinterpret_cast<__m128i*>(to + 16), a.hi);
+        }
+
+        lanes_t splat(const blt::u8 value)
+        {
+            const auto v = _mm_set1_epi8(static_cast<char>(value));
+            return {v, v};
+        }
+
+        lanes_t add(const lanes_t a, const lanes_t b)
+        {
+            return {_mm_add_epi8(a.lo, b.lo), _mm_add_epi8(a.hi, b.hi)};
+        }
+
+        lanes_t sub(const lanes_t a, const lanes_t b)
+        {
+            return {_mm_sub_epi8(a.lo, b.lo), _mm_sub_epi8(a.hi, b.hi)};
+        }
+
+        lanes_t max(const lanes_t a, const lanes_t b)
+        {
+            return {_mm_max_epu8(a.lo, b.lo), _mm_max_epu8(a.hi, b.hi)};
+        }
+
+        lanes_t either(const lanes_t a, const lanes_t b)
+        {
+            return {_mm_or_si128(a.lo, b.lo), _mm_or_si128(a.hi, b.hi)};
+        }
+
+        lanes_t greater(const lanes_t a, const lanes_t b)
+        {
+            return {_mm_cmpgt_epi8(a.lo, b.lo), _mm_cmpgt_epi8(a.hi, b.hi)};
+        }
+
+        lanes_t equal(const lanes_t a, const lanes_t b)
+        {
+            return {_mm_cmpeq_epi8(a.lo, b.lo), _mm_cmpeq_epi8(a.hi, b.hi)};
+        }
+#else
+        template <typename F>
+        lanes_t each(const lanes_t a, const lanes_t b, F&& f)
+        {
+            lanes_t result;
+            for (blt::size_t i = 0; i < batch_lanes; i++)
+                result.v[i] = static_cast<blt::u8>(f(a.v[i], b.v[i]));
+            return result;
+        }
+
+        void store(blt::u8* to, const lanes_t a)
+        {
+            std::memcpy(to, a.v, batch_lanes);
+        }
+
+        lanes_t splat(const blt::u8 value)
+        {
+            lanes_t result;
+            std::memset(result.v, value, batch_lanes);
+            return result;
+        }
+
+        lanes_t add(const lanes_t a, const lanes_t b)
+        {
+            return each(a, b, [](const blt::u8 x, const blt::u8 y) { return x + y; });
+        }
+
+        lanes_t sub(const lanes_t a, const lanes_t b)
+        {
+            return each(a, b, [](const blt::u8 x, const blt::u8 y) { return x - y; });
+        }
+
+        lanes_t max(const lanes_t a, const lanes_t b)
+        {
+            return each(a, b, [](const blt::u8 x, const blt::u8 y) { return std::max(x, y); });
+        }
+
+        lanes_t either(const lanes_t a, const lanes_t b)
+        {
+            return each(a, b, [](const blt::u8 x, const blt::u8 y) { return x | y; });
+        }
+
+        lanes_t greater(const lanes_t a, const lanes_t b)
+        {
+            return each(a, b, [](const blt::u8 x, const blt::u8 y) { return x > y ? 0xFF : 0; });
+        }
+
+        lanes_t equal(const lanes_t a, const lanes_t b)
+        {
+            return each(a, b, [](const blt::u8 x, const blt::u8 y) { return x == y ? 0xFF : 0; });
+        }
+#endif
+
+        static_assert(sizeof(lanes_t) == batch_lanes);
+
+        // the clue independent parts of one line's score, for every board in the batch. clues can be any i32 (negative or past the board
+        // size) while these all stay within a byte, so the distances to the clues are added outside of the lanes
+        struct line_lanes_t
+        {
+            lanes_t duplicates;
+            lanes_t sees_first;
+            lanes_t sees_last;
+        };
+
+        // cell i of the line sits at lanes[first + i * step]
+        line_lanes_t batch_line_lanes(const lanes_t* lanes, const blt::i32 board_size, const blt::size_t first, const blt::size_t step)
+        {
+            lanes_t line[max_simd_board_size];
+            for (blt::i32 i = 0; i < board_size; i++)
+                line[i] = lanes[first + i * step];
+
+            const auto zero = splat(0);
+            auto high = zero;
+            auto sees_first = zero;
+            for (blt::i32 i = 0; i < board_size; i++)
+            {
+                sees_first = sub(sees_first, greater(line[i], high));
+                high = max(high, line[i]);
+            }
+            high = zero;
+            auto sees_last = zero;
+            for (blt::i32 i = board_size - 1; i >= 0; i--)
+            {
+                sees_last = sub(sees_last, greater(line[i], high));
+                high = max(high, line[i]);
+            }
+
+            // distinct values, a lane counts each value it holds at least once
+            auto distinct = zero;
+            for (blt::i32 value = 1; value <= board_size; value++)
+            {
+                const auto wanted = splat(static_cast<blt::u8>(value));
+                auto present = zero;
+                for (blt::i32 i = 0; i < board_size; i++)
+                    present = either(present, equal(line[i], wanted));
+                distinct = sub(distinct, present);
+            }
+
+            return {sub(splat(static_cast<blt::u8>(2 * board_size)), add(distinct, distinct)), sees_first, sees_last};
+        }
+    }
+
+    void batch_line_scores(const problem_t& problem, const cell_t* const* boards, const blt::size_t count, blt::i32* fitness,
+                           blt::i32* const* line_scores)
+    {
+        const auto board_size = problem.board_size;
+        if (board_size > max_simd_board_size)
+        {
+            for (blt::size_t i = 0; i < count; i++)
+                fitness[i] = bitmask_line_scores(problem, boards[i], line_scores != nullptr ? line_scores[i] : nullptr);
+            return;
+        }
+
+        const auto cell_count = static_cast<blt::size_t>(board_size) * board_size;
+        // lanes[cell] holds that cell of every board in the batch
+        thread_local std::vector<lanes_t> lanes;
+        lanes.resize(cell_count);
+        alignas(32) blt::u8 duplicates[batch_lanes], sees_first[batch_lanes], sees_last[batch_lanes];
+
+        for (blt::size_t batch = 0; batch < count; batch += batch_lanes)
+        {
+            const auto size = std::min(batch_lanes, count - batch);
+            // lanes past the end of a short batch repeat its last board, their scores are never read
+            auto* transposed = reinterpret_cast<blt::u8*>(lanes.data());
+            for (blt::size_t lane = 0; lane < batch_lanes; lane++)
+            {
+                const auto* board = boards[batch + std::min(lane, size - 1)];
+                for (blt::size_t cell = 0; cell < cell_count; cell++)
+                    transposed[cell * batch_lanes + lane] = board[cell];
+            }
+
+            for (blt::size_t lane = 0; lane < size; lane++)
+                fitness[batch + lane] = 0;
+            for (blt::i32 i = 0; i < board_size * 2; i++)
+            {
+                const auto is_row = i < board_size;
+                const auto line = is_row ? i : i - board_size;
+                const auto first_clue = is_row ? problem.left[line] : problem.top[line];
+                const auto last_clue = is_row ? problem.right[line] : problem.bottom[line];
+                const auto counts = is_row ? batch_line_lanes(lanes.data(), board_size, line * board_size, 1)
+                                           : batch_line_lanes(lanes.data(), board_size, line, board_size);
+                store(duplicates, counts.duplicates);
+                store(sees_first, counts.sees_first);
+                store(sees_last, counts.sees_last);
+                for (blt::size_t lane = 0; lane < size; lane++)
+                {
+                    const auto score = duplicates[lane] + view_error(first_clue, sees_first[lane]) + view_error(last_clue, sees_last[lane]);
+                    fitness[batch + lane] += score;
+                    if (line_scores != nullptr)
+                        line_scores[batch + lane][i] = score;
+                }
+            }
+        }
+    }
+
+    blt::size_t hamming_distance(const cell_t* a, const cell_t* b, const blt::size_t count)
+    {
+        blt::size_t equal = 0;
+        blt::size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + 32 <= count; i += 32)
+        {
+            const auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            const auto y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            equal += static_cast<blt::size_t>(__builtin_popcount(static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)))));
+        }
+#endif
+#if defined(__SSE2__)
+        for (; i + 16 <= count; i += 16)
+        {
+            const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            const auto y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            equal += static_cast<blt::size_t>(__builtin_popcount(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)))));
+        }
+#endif
+        // swar, a byte of the xor is non zero exactly when the cells differ
+        for (; i + 8 <= count; i += 8)
+        {
+            blt::u64 x, y;
+            std::memcpy(&x, a + i, sizeof(x));
+            std::memcpy(&y, b + i, sizeof(y));
+            auto diff = x ^ y;
+            diff |= diff >> 4;
+            diff |= diff >> 2;
+            diff |= diff >> 1;
+            equal += 8 - static_cast<blt::size_t>(__builtin_popcountll(diff & 0x0101010101010101ull));
+        }
+        for (; i < count; i++)
+            equal += a[i] == b[i];
+        return count - equal;
+    }
+}
@@ -0,0 +1,126 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <fixed_board.h>
+#include <fitness_kernel.h>
+#include <array>
+#include <utility>
+
+namespace sky::kernel
+{
+    namespace
+    {
+        // values are at most 16 so a single word holds the occupancy of a line
+        template <blt::i32 N, blt::i32 Stride>
+        blt::i32 fixed_line_score(const cell_t* line, const blt::i32 first_clue, const blt::i32 last_clue)
+        {
+            blt::u32 occupancy = 0;
+            blt::i32 sees_first = 0;
+            blt::i32 highest_first = 0;
+            blt::i32 sees_last = 0;
+            blt::i32 highest_last = 0;
+            for (blt::i32 i = 0; i < N; i++)
+            {
+                const blt::i32 value = line[i * Stride];
+                occupancy |= 1u << value;
+                sees_first += value > highest_first;
+                highest_first = value > highest_first ? value : highest_first;
+
+                const blt::i32 back = line[(N - 1 - i) * Stride];
+                sees_last += back > highest_last;
+                highest_last = back > highest_last ? back : highest_last;
+            }
+            return 2 * (N - __builtin_popcount(occupancy)) + view_error(first_clue, sees_first) + view_error(last_clue, sees_last);
+        }
+
+        template <blt::i32 N>
+        blt::i32 fixed_row_score(const problem_t& problem, const cell_t* cells, const blt::i32 row)
+        {
+            return fixed_line_score<N, 1>(cells + row * N, problem.left[row], problem.right[row]);
+        }
+
+        template <blt::i32 N>
+        blt::i32 fixed_column_score(const problem_t& problem, const cell_t* cells, const blt::i32 column)
+        {
+            return fixed_line_score<N, N>(cells + column, problem.top[column], problem.bottom[column]);
+        }
+
+        template <blt::i32 N>
+        blt::i32 fixed_line_scores(const problem_t& problem, const cell_t* cells, blt::i32* line_scores)
+        {
+#if defined(__AVX2__)
+            // once lines fill a good part of a vector the transposed lane scans of the bitmask kernel win
+            if constexpr (N > 8)
+                return bitmask_line_scores(problem, cells, line_scores);
+#endif
+            blt::i32 fitness = 0;
+            for (blt::i32 i = 0; i < N; i++)
+            {
+                const auto row = fixed_row_score<N>(problem, cells, i);
+                const auto column = fixed_column_score<N>(problem, cells, i);
+                if (line_scores != nullptr)
+                {
+                    line_scores[i] = row;
+                    line_scores[N + i] = column;
+                }
+                fitness += row + column;
+            }
+            return fitness;
+        }
+
+        template <blt::i32 N>
+        void fixed_rescore_lines(const problem_t& problem, const cell_t* cells, blt::i32* line_scores, blt::i32& fitness, const dirty_lines_t& dirty)
+        {
+            for (blt::i32 i = 0; i < N; i++)
+            {
+                if (dirty.rows[i])
+                {
+                    fitness -= line_scores[i];
+                    line_scores[i] = fixed_row_score<N>(problem, cells, i);
+                    fitness += line_scores[i];
+                }
+                if (dirty.columns[i])
+                {
+                    fitness -= line_scores[N + i];
+                    line_scores[N + i] = fixed_column_score<N>(problem, cells, i);
+                    fitness += line_scores[N + i];
+                }
+            }
+        }
+
+        template <blt::i32... Offsets>
+        constexpr std::array<fixed_kernel_set_t, sizeof...(Offsets)> make_fixed_kernels(std::integer_sequence<blt::i32, Offsets...>)
+        {
+            return {
+                fixed_kernel_set_t{
+                    &fixed_row_score<min_fixed_board_size + Offsets>, &fixed_column_score<min_fixed_board_size + Offsets>,
+                    &fixed_line_scores<min_fixed_board_size + Offsets>, &fixed_rescore_lines<min_fixed_board_size + Offsets>
+                }...
+            };
+        }
+
+        constexpr auto fixed_kernel_table = make_fixed_kernels(
+            std::make_integer_sequence<blt::i32, max_fixed_board_size - min_fixed_board_size + 1>{});
+    }
+
+    const fixed_kernel_set_t* fixed_kernels(const blt::i32 board_size)
+    {
+        if (board_size < min_fixed_board_size || board_size > max_fixed_board_size)
+            return nullptr;
+        return &fixed_kernel_table[board_size - min_fixed_board_size];
+    }
+}
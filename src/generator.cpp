@@ -0,0 +1,168 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <generator.h>
+#include <blt/std/logging.h>
+
+namespace sky
+{
+    namespace
+    {
+        blt::i32 visible_count(const solution_t& solution, const blt::i32 line, const bool along_row, const bool reverse)
+        {
+            const auto size = solution.board_size;
+            blt::i32 seen = 0;
+            blt::i32 highest = 0;
+            for (blt::i32 i = 0; i < size; i++)
+            {
+                const auto p = reverse ? size - 1 - i : i;
+                const auto value = along_row ? solution.get(line, p) : solution.get(p, line);
+                if (value > highest)
+                {
+                    ++seen;
+                    highest = value;
+                }
+            }
+            return seen;
+        }
+    }
+
+    problem_t problem_from_solution(const solution_t& solution)
+    {
+        problem_t problem{solution.board_size};
+        for (blt::i32 i = 0; i < solution.board_size; i++)
+        {
+            problem.top.push_back(visible_count(solution, i, false, false));
+            problem.bottom.push_back(visible_count(solution, i, false, true));
+            problem.left.push_back(visible_count(solution, i, true, false));
+            problem.right.push_back(visible_count(solution, i, true, true));
+        }
+        return problem;
+    }
+
+    solution_t puzzle_generator_t::random_latin_square(const blt::i32 size, blt::i64 steps)
+    {
+        if (size <= 0 || size > max_board_size)
+        {
+            BLT_WARN("Cannot generate a latin square of size %d, sizes must be within [1, %d]", size, max_board_size);
+            return solution_t{0};
+        }
+
+        const auto n = static_cast<blt::size_t>(size);
+        if (steps <= 0)
+            steps = static_cast<blt::i64>(n * n * n);
+
+        // incidence cube, cube[(row * n + column) * n + symbol] is 1 when the cell holds the symbol. an improper cube has exactly one -1 entry
+        std::vector<blt::i8> cube(n * n * n, 0);
+        const auto at = [&cube, n](const blt::size_t row, const blt::size_t column, const blt::size_t symbol) -> blt::i8&
+        {
+            return cube[(row * n + column) * n + symbol];
+        };
+        for (blt::size_t row = 0; row < n; row++)
+        {
+            for (blt::size_t column = 0; column < n; column++)
+                at(row, column, (row + column) % n) = 1;
+        }
+
+        // picks one of the (one or two) positions along an axis holding a 1, the other coordinates fixed
+        const auto pick_one = [this, n](auto&& value_at)
+        {
+            blt::size_t found[2] = {0, 0};
+            blt::size_t count = 0;
+            for (blt::size_t i = 0; i < n && count < 2; i++)
+            {
+                if (value_at(i) == 1)
+                    found[count++] = i;
+            }
+            return count == 2 && random.choice() ? found[1] : found[0];
+        };
+
+        bool proper = true;
+        blt::size_t improper[3] = {0, 0, 0};
+        for (blt::i64 step = 0; step < steps || !proper; step++)
+        {
+            blt::size_t r, c, s;
+            if (proper)
+            {
+                do
+                {
+                    r = random.get_size_t(0, n);
+                    c = random.get_size_t(0, n);
+                    s = random.get_size_t(0, n);
+                } while (at(r, c, s) != 0 && n > 1);
+                if (n == 1)
+                    break;
+            } else
+            {
+                r = improper[0];
+                c = improper[1];
+                s = improper[2];
+            }
+
+            const auto r1 = pick_one([&](const blt::size_t i)
+            {
+                return at(i, c, s);
+            });
+            const auto c1 = pick_one([&](const blt::size_t i)
+            {
+                return at(r, i, s);
+            });
+            const auto s1 = pick_one([&](const blt::size_t i)
+            {
+                return at(r, c, i);
+            });
+
+            ++at(r, c, s);
+            --at(r1, c, s);
+            --at(r, c1, s);
+            --at(r, c, s1);
+            ++at(r1, c1, s);
+            ++at(r1, c, s1);
+            ++at(r, c1, s1);
+            --at(r1, c1, s1);
+
+            proper = at(r1, c1, s1) != -1;
+            if (!proper)
+            {
+                improper[0] = r1;
+                improper[1] = c1;
+                improper[2] = s1;
+            }
+        }
+
+        solution_t solution{size};
+        for (blt::size_t row = 0; row < n; row++)
+        {
+            for (blt::size_t column = 0; column < n; column++)
+            {
+                for (blt::size_t symbol = 0; symbol < n; symbol++)
+                {
+                    if (at(row, column, symbol) == 1)
+                        solution.set(static_cast<blt::i32>(row), static_cast<blt::i32>(column), static_cast<blt::i32>(symbol) + 1);
+                }
+            }
+        }
+        return solution;
+    }
+
+    generated_puzzle_t puzzle_generator_t::generate(const blt::i32 size, const blt::i64 steps)
+    {
+        auto solution = random_latin_square(size, steps);
+        auto problem = problem_from_solution(solution);
+        return {std::move(problem), std::move(solution)};
+    }
+}
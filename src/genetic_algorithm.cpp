@@ -16,142 +16,734 @@
  *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #include <genetic_algorithm.h>
-#include <blt/std/hashmap.h>
+#include <allocation_tracker.h>
 #include <blt/std/logging.h>
 #include <blt/std/random.h>
 #include <blt/std/utility.h>
+#include <algorithm>
+#include <chrono>
+#include <numeric>
 
 namespace sky
 {
+    genetic_algorithm::genetic_algorithm(const checkpoint_t& checkpoint):
+        crossover_rate(checkpoint.header().crossover_rate), mutation_rate(checkpoint.header().mutation_rate), m_problem(checkpoint.problem()),
+        seed(checkpoint.header().run_seed), control_random(rng::stream(rng::stream(seed, checkpoint.header().generation), control_stream))
+    {
+        const auto& header = checkpoint.header();
+        m_problem.propagate_domains();
+        kernel = static_cast<fitness_kernel_t>(header.kernel);
+        evaluation = static_cast<evaluation_t>(header.evaluation);
+        selector.set_strategy(static_cast<selection_t>(header.selection), header.selection_pressure);
+        local_search.mode = static_cast<local_search_t>(header.local_search_mode);
+        local_search.elites = header.local_search_elites;
+        local_search.max_moves = header.local_search_max_moves;
+        local_search.tabu_tenure = header.local_search_tabu_tenure;
+        duplicate_policy = static_cast<duplicate_policy_t>(header.duplicate_policy);
+        encoding = static_cast<encoding_t>(header.encoding);
+        if (encoding == encoding_t::ROW_PERMUTATION)
+            row_tables.build(m_problem, static_cast<blt::size_t>(header.max_row_entries));
+        replacement.mode = static_cast<replacement_t>(header.replacement_mode);
+        replacement.neighbourhood = header.replacement_neighbourhood;
+        replacement.sharing_radius = header.sharing_radius;
+        steady.births = header.steady_births;
+        steady.victim = static_cast<steady_victim_t>(header.steady_victim);
+        cache.resize(header.cache_entries, m_problem.board_size);
+        generation = header.generation;
+
+        const auto count = static_cast<blt::size_t>(header.individual_count);
+        populations[0].resize(m_problem.board_size, count);
+        populations[1].resize(m_problem.board_size, count);
+        order.resize(count);
+        for (blt::size_t i = 0; i < count; i++)
+            populations[current].assign(i, checkpoint.cells(i), checkpoint.line_scores(i), checkpoint.fitness(i));
+    }
+
+    void genetic_algorithm::set_worker_count(const blt::size_t count)
+    {
+        if (count <= 1)
+            pool.reset();
+        else if (!pool || pool->size() != count)
+            pool = std::make_unique<worker_pool_t>(count);
+    }
+
     void genetic_algorithm::run_step(const blt::i32 elites, const blt::i32 k)
     {
-        std::vector<individual_t> next_generation;
+        const auto allocations_before = allocations::count();
+        if (telemetry)
+        {
+            for (auto* counter : {&phase_counters.evaluations, &phase_counters.select_ns, &phase_counters.crossover_ns, &phase_counters.mutate_ns,
+                                  &phase_counters.evaluate_ns})
+                counter->store(0, std::memory_order_relaxed);
+        }
+        phase_counters.rejections.store(0, std::memory_order_relaxed);
+
+        if (steady.births > 0)
+            step_steady(elites, k);
+        else
+            step_generational(elites, k);
+
+        // swapping two cells of a row can produce a row that is not in its table, so row permutation boards are never refined
+        if (local_search.mode != local_search_t::NONE && encoding != encoding_t::ROW_PERMUTATION)
+            refine_elites();
+
+        ++generation;
+        restart_control();
+        last_diversity = diversity();
+        last_rejections = phase_counters.rejections.load(std::memory_order_relaxed);
+        if (telemetry)
+        {
+            generation_record_t record{};
+            record.generation = generation;
+            record.evaluations = phase_counters.evaluations.load(std::memory_order_relaxed);
+            record.select_ns = phase_counters.select_ns.load(std::memory_order_relaxed);
+            record.crossover_ns = phase_counters.crossover_ns.load(std::memory_order_relaxed);
+            record.mutate_ns = phase_counters.mutate_ns.load(std::memory_order_relaxed);
+            record.evaluate_ns = phase_counters.evaluate_ns.load(std::memory_order_relaxed);
+            record.average_fitness = average_fitness();
+            record.diversity = last_diversity;
+            record.best_fitness = best_fitness();
+            telemetry->push(record);
+        }
+        if (snapshots)
+            publish_snapshot();
+
+        last_step_allocations = allocations::count() - allocations_before;
+    }
+
+    void genetic_algorithm::step_generational(const blt::i32 elites, const blt::i32 k)
+    {
+        const auto& individuals = populations[current];
+        // children are written straight into their slot of the other buffer, so the generation never changes size
+        auto& next_generation = populations[current ^ 1];
+        next_generation.resize(m_problem.board_size, individuals.size());
+
+        const auto elite_count = std::min(static_cast<blt::size_t>(std::max(elites, 0)), individuals.size());
+        if (elite_count > 0)
+        {
+            rank_best(elite_count);
+            for (blt::size_t i = 0; i < elite_count; ++i)
+                next_generation.copy(i, individuals, order[i]);
+        }
+
+        selector.prepare(individuals, get_random());
+        if (replacement.mode != replacement_t::GENERATIONAL)
+        {
+            // selection pressure comes from the contests alone, every member is a parent of the slot it was shuffled to
+            pairing.resize(individuals.size());
+            std::iota(pairing.begin(), pairing.end(), 0);
+            auto& random = get_random();
+            for (blt::size_t i = pairing.size(); i > 1; i--)
+                std::swap(pairing[i - 1], pairing[random.get_size_t(0, i)]);
+        }
+
+        build_range(next_generation, elite_count, individuals.size(), k);
+
+        if (duplicate_policy != duplicate_policy_t::ALLOW)
+            remove_duplicates(next_generation, elite_count);
+
+        current ^= 1;
+        heap_stale = true;
+    }
+
+    void genetic_algorithm::step_steady(const blt::i32 elites, const blt::i32 k)
+    {
+        auto& individuals = populations[current];
+        if (heap_stale || heap.size() != individuals.size())
+        {
+            heap.build(individuals.fitness_values());
+            steady_hashes.reset(individuals.size());
+            for (blt::size_t i = 0; i < individuals.size(); i++)
+                steady_hashes.add(individuals.hash(i));
+            heap_stale = false;
+        }
+
+        // the batch is bred into the spare buffer from the population as it stood, then inserted one child at a time in birth order so
+        // the result does not depend on the worker count. the buffer only ever needs a batch, storage left from generational steps is freed
+        auto& offspring = populations[current ^ 1];
+        const auto births = std::min(steady.births, individuals.size());
+        offspring.resize(m_problem.board_size, births);
+        offspring.shrink_to_fit();
+        selector.prepare(individuals, get_random());
+        build_range(offspring, 0, births, k);
+
+        blt::u64 rejected = 0;
+        for (blt::size_t i = 0; i < births; i++)
+        {
+            const auto victim = steady_victim(elites, k);
+            const bool duplicate = duplicate_policy != duplicate_policy_t::ALLOW && steady_hashes.contains(offspring.hash(i));
+            // a child never pushes out a fitter member
+            if (duplicate || offspring.fitness(i) > heap.fitness(victim))
+            {
+                ++rejected;
+                continue;
+            }
+            steady_hashes.remove(individuals.hash(victim));
+            steady_hashes.add(offspring.hash(i));
+            individuals.copy(victim, offspring, i);
+            heap.update(victim, offspring.fitness(i));
+        }
+        phase_counters.rejections.fetch_add(rejected, std::memory_order_relaxed);
+    }
+
+    blt::size_t genetic_algorithm::steady_victim(const blt::i32 elites, const blt::i32 k)
+    {
+        if (steady.victim == steady_victim_t::WORST)
+            return heap.worst();
+        auto& random = get_random();
+        auto loser = random.get_size_t(0, heap.size());
+        for (blt::i32 i = 1; i < k; i++)
+        {
+            const auto other = random.get_size_t(0, heap.size());
+            if (heap.fitness(other) > heap.fitness(loser))
+                loser = other;
+        }
+        if (elites > 0 && loser == heap.best())
+            return heap.worst();
+        return loser;
+    }
+
+    void genetic_algorithm::build_range(population_t& next_generation, const blt::size_t begin, const blt::size_t end, const blt::i32 k)
+    {
+        if (!pool)
+        {
+            build_slice(next_generation, begin, end, k);
+            return;
+        }
+        // slices are whole pairs of slots, see build_slice
+        const auto workers = pool->size();
+        const auto pairs = (end - begin + 1) / 2;
+        const auto per_worker = pairs / workers;
+        const auto leftover = pairs % workers;
+
+        auto job = [this, &next_generation, begin, end, per_worker, leftover, k](const blt::size_t task)
+        {
+            const auto slice_begin = begin + (task * per_worker + std::min(task, leftover)) * 2;
+            const auto slice_end = std::min(end, slice_begin + (per_worker + (task < leftover ? 1 : 0)) * 2);
+            if (slice_begin < slice_end)
+                build_slice(next_generation, slice_begin, slice_end, k);
+        };
+        pool->run(job);
+    }
+
+    void genetic_algorithm::publish_snapshot()
+    {
+        rank_best(1);
+        const auto& individuals = populations[current];
+        auto& snapshot = snapshots->write_buffer();
+        snapshot.generation = generation;
+        snapshot.best_fitness = individuals.fitness(order[0]);
+        snapshot.average_fitness = average_fitness();
+        snapshot.diversity = last_diversity;
+        snapshot.board_size = m_problem.board_size;
+        std::copy_n(individuals.cells(order[0]), snapshot.best_board.size(), snapshot.best_board.begin());
+        snapshots->publish();
+    }
+
+    solution_t genetic_algorithm::solve(const blt::i32 max_generations, const blt::i32 elites, const blt::i32 k)
+    {
+        for (blt::i32 generation = 0; generation < max_generations; generation++)
+        {
+            rank_best(1);
+            if (populations[current].fitness(order.front()) == 0)
+                break;
+            run_step(elites, k);
+        }
+        return get_best(1).front().solution;
+    }
+
+    void genetic_algorithm::build_slice(population_t& next_generation, const blt::size_t begin, const blt::size_t end, const blt::i32 k) const
+    {
+        const auto& individuals = populations[current];
+
+        thread_local dirty_lines_t first_dirty{0};
+        thread_local dirty_lines_t second_dirty{0};
 
         const double total_chance = crossover_rate + mutation_rate;
         const double adjusted_crossover = crossover_rate / total_chance;
 
-        if (elites > 0)
+        // phase timers only run when telemetry is attached, each lap charges the time since the previous one to a phase
+        const bool timed = telemetry != nullptr;
+        blt::u64 select_ns = 0, crossover_ns = 0, mutate_ns = 0, evaluate_ns = 0;
+        blt::u64 evaluated = 0;
+        blt::u64 rejected = 0;
+        const bool contested = steady.births == 0 && replacement.mode != replacement_t::GENERATIONAL;
+        auto mark = timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+        const auto lap = [timed, &mark](blt::u64& total)
         {
-            std::sort(individuals.begin(), individuals.end(), [](const auto& a, const auto& b)
-            {
-                return a.fitness < b.fitness;
-            });
-            for (blt::i32 i = 0; i < elites; ++i)
-                next_generation.push_back(individuals[i]);
+            if (!timed)
+                return;
+            const auto now = std::chrono::steady_clock::now();
+            total += static_cast<blt::u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - mark).count());
+            mark = now;
+        };
+
+        // with BATCHED evaluation children are only bred in the loop, the ones needing scores are queued and scored together afterwards.
+        // contests wait for the scores, so each pair keeps its parents and stream until then
+        const bool batched = evaluation == evaluation_t::BATCHED;
+        thread_local std::vector<std::pair<bred_pair_t, blt::random::random_t>> bred;
+        thread_local std::vector<blt::size_t> pending;
+        bred.clear();
+        pending.clear();
+        // how many children need scores changes every generation, reserving the whole slice keeps later generations from growing these
+        if (batched)
+        {
+            bred.reserve((end - begin + 1) / 2);
+            pending.reserve(end - begin);
         }
 
-        for (blt::size_t i = 0; i < individuals.size(); i++)
+        const auto finish = [this, &individuals, &next_generation, batched, &evaluated](const blt::size_t slot, const blt::size_t parent,
+                                                                                         dirty_lines_t& dirty)
         {
-            if (get_random().choice(adjusted_crossover))
+            restore_fixed(next_generation.cells(slot), dirty);
+            next_generation.copy_scores(slot, individuals, parent);
+            if (!batched)
+                evaluated += score_child(next_generation, slot, individuals.cells(parent), dirty);
+            else if (child_changed(next_generation, slot, individuals.cells(parent), dirty))
+                pending.push_back(slot);
+        };
+
+        // slots are built in pairs, each from the pair's own stream, so a child does not depend on which worker built it or what that
+        // worker built before. slices always start on a pair. a slot owns the selection draw positions slot * 2 and slot * 2 + 1
+        const auto step_key = rng::stream(seed, generation);
+        for (blt::size_t i = begin; i < end; i += 2)
+        {
+            blt::random::random_t random{rng::stream(step_key, i)};
+            bred_pair_t pair{i, 0, 0, false, i + 1 < end};
+            if (random.choice(adjusted_crossover))
             {
-                const solution_t& p1 = select(k);
-                const solution_t* p2;
-                do
+                const auto p1 = contested ? pairing[i] : select(k, random, i * 2);
+                auto p2 = contested ? pairing[(i + 1) % pairing.size()] : select(k, random, i * 2 + 1);
+                if (p2 == p1 && individuals.size() > 1)
                 {
-                    p2 = &select(k);
+                    // strongly converged populations can keep choosing the same parent. re-picks come from their own streams, at random
+                    // draw positions, so they never take a parent meant for another slot. after that fall back to a uniform pick
+                    const auto retry_key = rng::stream(rng::stream(step_key, i), retry_stream);
+                    for (blt::u64 attempt = 0; p2 == p1 && attempt < 8; attempt++)
+                    {
+                        blt::random::random_t retry{rng::stream(retry_key, attempt)};
+                        p2 = select(k, retry, retry.get_size_t(0, individuals.size() * 2));
+                    }
+                    if (p2 == p1)
+                    {
+                        blt::random::random_t retry{rng::stream(retry_key, 8)};
+                        p2 = retry.get_size_t(0, individuals.size() - 1);
+                        if (p2 >= p1)
+                            ++p2;
+                    }
                 }
-                while (p2 == &p1);
+                lap(select_ns);
 
-                auto [c1, c2] = crossover(p1, *p2);
-                next_generation.emplace_back(c1, c1.fitness(m_problem));
-                if (next_generation.size() + 1 < individuals.size())
+                first_dirty.reset(m_problem.board_size);
+                second_dirty.reset(m_problem.board_size);
+                crossover(individuals.cells(p1), individuals.cells(p2), next_generation.cells(i), pair.both ? next_generation.cells(i + 1) : nullptr,
+                          first_dirty, second_dirty, random);
+                lap(crossover_ns);
+                finish(i, p1, first_dirty);
+                if (pair.both)
+                    finish(i + 1, p2, second_dirty);
+                pair.crossed = true;
+                pair.first_parent = p1;
+                pair.second_parent = p2;
+                lap(evaluate_ns);
+            }
+            else
+            {
+                // both slots of the pair are mutants of separately chosen parents
+                for (blt::size_t slot = i; slot < i + (pair.both ? 2 : 1); slot++)
                 {
-                    next_generation.emplace_back(c2, c2.fitness(m_problem));
-                    ++i;
+                    const auto p1 = contested ? pairing[slot] : select(k, random, slot * 2);
+                    lap(select_ns);
+                    first_dirty.reset(m_problem.board_size);
+                    mutate(individuals.cells(p1), next_generation.cells(slot), first_dirty, random);
+                    lap(mutate_ns);
+                    finish(slot, p1, first_dirty);
+                    (slot == i ? pair.first_parent : pair.second_parent) = p1;
+                    lap(evaluate_ns);
                 }
             }
+
+            if (!contested)
+                continue;
+            if (batched)
+                bred.emplace_back(pair, random);
             else
             {
-                const solution_t& p1 = select(k);
-                auto c1 = mutate(p1);
-                next_generation.emplace_back(c1, c1.fitness(m_problem));
+                rejected += contest(next_generation, pair, random);
+                lap(evaluate_ns);
             }
         }
 
-        individuals.clear();
-        individuals = std::move(next_generation);
+        if (batched)
+        {
+            next_generation.evaluate_batch(pending.data(), pending.size(), m_problem);
+            if (cache.enabled())
+            {
+                for (const auto slot : pending)
+                    cache.insert(next_generation.hash(slot), next_generation.line_scores(slot), next_generation.fitness(slot));
+            }
+            evaluated += pending.size();
+            for (auto& [pair, random] : bred)
+                rejected += contest(next_generation, pair, random);
+            lap(evaluate_ns);
+        }
+
+        if (rejected > 0)
+            phase_counters.rejections.fetch_add(rejected, std::memory_order_relaxed);
+        if (timed)
+        {
+            phase_counters.evaluations.fetch_add(evaluated, std::memory_order_relaxed);
+            phase_counters.select_ns.fetch_add(select_ns, std::memory_order_relaxed);
+            phase_counters.crossover_ns.fetch_add(crossover_ns, std::memory_order_relaxed);
+            phase_counters.mutate_ns.fetch_add(mutate_ns, std::memory_order_relaxed);
+            phase_counters.evaluate_ns.fetch_add(evaluate_ns, std::memory_order_relaxed);
+        }
     }
 
-    double genetic_algorithm::average_fitness() const
+    bool genetic_algorithm::child_changed(population_t& next_generation, const blt::size_t index, const cell_t* parent,
+                                          const dirty_lines_t& dirty) const
     {
-        double total_fitness = 0.0;
-
-        for (const auto& i : individuals)
-            total_fitness += i.fitness;
+        // no-op children (a point mutation writing back the same value, a shuffle restoring the order) keep their parent's scores
+        if (!next_generation.update_hash(index, parent, dirty))
+            return false;
+        return !cache.enabled() || !cache.lookup(next_generation.hash(index), next_generation.line_scores(index), next_generation.fitness(index));
+    }
 
-        return total_fitness / static_cast<double>(individuals.size());
+    bool genetic_algorithm::score_child(population_t& next_generation, const blt::size_t index, const cell_t* parent,
+                                        const dirty_lines_t& dirty) const
+    {
+        if (!child_changed(next_generation, index, parent, dirty))
+            return false;
+        next_generation.rescore(index, m_problem, dirty, kernel);
+        if (cache.enabled())
+            cache.insert(next_generation.hash(index), next_generation.line_scores(index), next_generation.fitness(index));
+        return true;
     }
 
-    std::vector<individual_t> genetic_algorithm::get_best(const blt::i32 amount)
+    blt::u64 genetic_algorithm::contest(population_t& next_generation, const bred_pair_t& pair, blt::random::random_t& random) const
     {
-        std::sort(individuals.begin(), individuals.end(), [](const auto& a, const auto& b)
+        const auto& individuals = populations[current];
+        const auto i = pair.slot;
+        const auto p1 = pair.first_parent;
+        const auto p2 = pair.second_parent;
+        if (!pair.crossed)
         {
-            return a.fitness < b.fitness;
-        });
+            blt::u64 rejected = replace_child(next_generation, i, p1, random);
+            if (pair.both)
+                rejected += replace_child(next_generation, i + 1, p2, random);
+            return rejected;
+        }
+        if (!pair.both)
+        {
+            const bool closer = next_generation.distance(i, individuals.cells(p2)) < next_generation.distance(i, individuals.cells(p1));
+            return replace_child(next_generation, i, closer ? p2 : p1, random);
+        }
+        // each child contests the parent it is closer to, taking the pairing with the smaller total distance
+        const auto straight = next_generation.distance(i, individuals.cells(p1)) + next_generation.distance(i + 1, individuals.cells(p2));
+        const auto crossed = next_generation.distance(i, individuals.cells(p2)) + next_generation.distance(i + 1, individuals.cells(p1));
+        blt::u64 rejected = replace_child(next_generation, i, crossed < straight ? p2 : p1, random);
+        rejected += replace_child(next_generation, i + 1, crossed < straight ? p1 : p2, random);
+        return rejected;
+    }
 
-        std::vector<individual_t> best;
-        for (blt::size_t i = 0; i < static_cast<blt::size_t>(amount); i++)
-            best.push_back(individuals[i]);
+    bool genetic_algorithm::replace_child(population_t& next_generation, const blt::size_t index, const blt::size_t parent,
+                                          blt::random::random_t& random) const
+    {
+        const auto& individuals = populations[current];
+        const auto child_fitness = next_generation.fitness(index);
+        const auto parent_fitness = individuals.fitness(parent);
+        // a solution is never given up, whatever its neighbourhood
+        if (child_fitness == 0)
+            return false;
 
-        return best;
+        bool parent_wins = parent_fitness < child_fitness;
+        if (replacement.mode == replacement_t::FITNESS_SHARING && replacement.neighbourhood > 0)
+        {
+            // both contestants are measured against the same sample of the current population
+            thread_local std::vector<blt::size_t> neighbours;
+            neighbours.resize(replacement.neighbourhood);
+            for (auto& neighbour : neighbours)
+                neighbour = random.get_size_t(0, individuals.size());
+            parent_wins = shared_fitness(parent_fitness, individuals.cells(parent), parent, neighbours.data()) <
+                shared_fitness(child_fitness, next_generation.cells(index), individuals.size(), neighbours.data());
+        }
+        if (!parent_wins)
+            return false;
+        next_generation.copy(index, individuals, parent);
+        return true;
     }
 
-    blt::random::random_t& genetic_algorithm::get_random() const // NOLINT
+    double genetic_algorithm::shared_fitness(const blt::i32 fitness, const cell_t* board, const blt::size_t exclude,
+                                             const blt::size_t* neighbours) const
     {
-        thread_local blt::random::random_t random{std::random_device{}()};
-        return random;
+        const auto& individuals = populations[current];
+        const auto cell_count = static_cast<double>(m_problem.board_size) * m_problem.board_size;
+        const auto radius = std::max(1.0, replacement.sharing_radius * cell_count);
+        // niche count, the board itself plus the triangular sharing function of every sampled neighbour within the radius
+        double niche = 1;
+        for (blt::size_t i = 0; i < replacement.neighbourhood; i++)
+        {
+            if (neighbours[i] == exclude)
+                continue;
+            const auto distance = static_cast<double>(individuals.distance(neighbours[i], board));
+            if (distance < radius)
+                niche += 1 - distance / radius;
+        }
+        // fitness is minimized and reaches zero, so the offset keeps crowding meaningful for near solutions
+        return (fitness + 1) * niche;
     }
 
-    const solution_t& genetic_algorithm::select(const blt::i32 k) const
+    void genetic_algorithm::evaluate_batch(population_t& population, const blt::size_t begin, const blt::size_t end) const
     {
-        thread_local blt::hashset_t<blt::size_t> selected_indexes;
-        selected_indexes.clear();
+        thread_local std::vector<blt::size_t> indexes;
+        indexes.resize(end - begin);
+        std::iota(indexes.begin(), indexes.end(), begin);
+        population.evaluate_batch(indexes.data(), indexes.size(), m_problem);
+        for (const auto index : indexes)
+            population.rehash(index);
+    }
 
-        blt::size_t index = 0;
-        blt::i32 best_fitness = std::numeric_limits<blt::i32>::max();
+    void genetic_algorithm::remove_duplicates(population_t& next_generation, const blt::size_t elite_count)
+    {
+        hash_order.resize(next_generation.size());
+        for (blt::size_t i = 0; i < next_generation.size(); i++)
+            hash_order[i] = {next_generation.hash(i), i};
+        // equal hashes end up adjacent with the lowest index (elites first) leading, which is the copy that is kept
+        std::sort(hash_order.begin(), hash_order.end());
 
-        for (blt::i32 i = 0; i < k; ++i)
+        const auto cell_count = static_cast<blt::size_t>(m_problem.board_size) * m_problem.board_size;
+        for (blt::size_t i = 1; i < hash_order.size(); i++)
         {
-            blt::size_t point;
-            do
+            const auto index = hash_order[i].second;
+            if (hash_order[i].first != hash_order[i - 1].first || index < elite_count)
+                continue;
+            if (duplicate_policy == duplicate_policy_t::REPLACE)
             {
-                point = get_random().get_u64(0, individuals.size());
+                randomize(next_generation, index, get_random());
+                continue;
             }
-            while (selected_indexes.contains(point));
-            selected_indexes.insert(point);
-            if (individuals[point].fitness < best_fitness)
+            // a mutation can leave the board as it was (zero points, a swap of equal values, a shuffle back into place), so it is
+            // redrawn until a cell changes and the board is replaced when that keeps failing
+            constexpr blt::i32 max_remutations = 8;
+            scratch_board.assign(next_generation.cells(index), next_generation.cells(index) + cell_count);
+            bool changed = false;
+            for (blt::i32 attempt = 0; attempt < max_remutations && !changed; attempt++)
             {
-                index = point;
-                best_fitness = individuals[point].fitness;
+                scratch_dirty.reset(m_problem.board_size);
+                mutate(scratch_board.data(), next_generation.cells(index), scratch_dirty, get_random());
+                restore_fixed(next_generation.cells(index), scratch_dirty);
+                changed = std::memcmp(scratch_board.data(), next_generation.cells(index), cell_count) != 0;
             }
+            if (changed)
+                (void) score_child(next_generation, index, scratch_board.data(), scratch_dirty);
+            else
+                randomize(next_generation, index, get_random());
         }
-        return individuals[index].solution;
     }
 
-    std::pair<solution_t, solution_t> genetic_algorithm::crossover(solution_t first, solution_t second) const
+    void genetic_algorithm::randomize(population_t& population, const blt::size_t index, blt::random::random_t& random) const
     {
-        auto& random = get_random();
+        auto* cells = population.cells(index);
+        if (encoding == encoding_t::ROW_PERMUTATION)
+        {
+            for (blt::i32 row = 0; row < m_problem.board_size; row++)
+                row_tables.sample(m_problem, row, random, cells + row * m_problem.board_size);
+            population.evaluate(index, m_problem, kernel);
+            return;
+        }
+        const auto cell_count = static_cast<blt::size_t>(m_problem.board_size) * m_problem.board_size;
+        for (blt::size_t i = 0; i < cell_count; i++)
+        {
+            if (m_problem.has_domains())
+                cells[i] = m_problem.domain_value(i, random.get_i32(0, m_problem.domain_size(i)));
+            else
+                cells[i] = static_cast<cell_t>(random.get_i32(m_problem.min(), m_problem.max() + 1));
+        }
+        population.evaluate(index, m_problem, kernel);
+    }
 
-        const auto first_begin = random.get_size_t(0, first.board_data.size() - 1);
-        const auto first_end = random.get_size_t(first_begin + 1, first.board_data.size());
+    void genetic_algorithm::set_encoding(const encoding_t new_encoding, const blt::size_t max_row_entries)
+    {
+        encoding = new_encoding;
+        if (encoding != encoding_t::ROW_PERMUTATION)
+            return;
+        row_tables.build(m_problem, max_row_entries);
+        auto& individuals = populations[current];
+        const auto encoding_key = rng::stream(seed, encoding_stream);
+        for (blt::size_t i = 0; i < individuals.size(); i++)
+        {
+            blt::random::random_t random{rng::stream(encoding_key, i)};
+            randomize(individuals, i, random);
+        }
+        heap_stale = true;
+    }
 
-        const auto size = first_end - first_begin;
+    void genetic_algorithm::refine_elites()
+    {
+        auto& individuals = populations[current];
+        const auto count = std::min(static_cast<blt::size_t>(std::max(local_search.elites, 0)), individuals.size());
+        rank_best(count);
+        for (blt::size_t i = 0; i < count; i++)
+        {
+            if (local_search.mode == local_search_t::HILL_CLIMB)
+                (void) hill_climb(m_problem, individuals, order[i], kernel, get_random(), local_search.max_moves);
+            else
+                (void) tabu_search(m_problem, individuals, order[i], kernel, local_search.max_moves, local_search.tabu_tenure);
+            individuals.rehash(order[i]);
+        }
+        heap_stale = true;
+    }
 
-        const auto second_begin = random.get_size_t(0, second.board_size * second.board_size - size);
+    void genetic_algorithm::restore_fixed(cell_t* cells, dirty_lines_t& dirty) const
+    {
+        for (const auto index : m_problem.get_fixed_cells())
+        {
+            const auto value = m_problem.domain_value(index, 0);
+            if (cells[index] == value)
+                continue;
+            cells[index] = value;
+            dirty.mark_index(index);
+        }
+    }
 
-        std::vector<blt::i32> temp;
-        temp.resize(size);
+    void genetic_algorithm::rank_best(const blt::size_t amount)
+    {
+        const auto& fitness = populations[current].fitness_values();
+        order.resize(fitness.size());
+        std::iota(order.begin(), order.end(), 0);
+        const auto middle = order.begin() + static_cast<std::ptrdiff_t>(std::min(amount, order.size()));
+        std::partial_sort(order.begin(), middle, order.end(), [&fitness](const auto a, const auto b)
+        {
+            return fitness[a] < fitness[b];
+        });
+    }
 
-        std::memcpy(temp.data(), second.board_data.data() + second_begin, sizeof(blt::i32) * size);
-        std::memcpy(second.board_data.data() + second_begin, first.board_data.data() + first_begin, sizeof(blt::i32) * size);
-        std::memcpy(first.board_data.data() + first_begin, temp.data(), sizeof(blt::i32) * size);
+    double genetic_algorithm::average_fitness() const
+    {
+        double total_fitness = 0.0;
 
-        return {first, second};
+        for (const auto fitness : populations[current].fitness_values())
+            total_fitness += fitness;
+
+        return total_fitness / static_cast<double>(populations[current].size());
     }
 
-    solution_t genetic_algorithm::mutate(solution_t individual) const
+    blt::i32 genetic_algorithm::best_fitness() const
     {
-        auto& random = get_random();
+        const auto& fitness = populations[current].fitness_values();
+        return *std::min_element(fitness.begin(), fitness.end());
+    }
+
+    double genetic_algorithm::diversity(const blt::size_t pairs) const
+    {
+        blt::random::random_t sample{rng::stream(rng::stream(seed, generation), diversity_stream)};
+        return populations[current].diversity(pairs, sample);
+    }
+
+    void genetic_algorithm::reseed(const double fraction, const blt::i32 keep)
+    {
+        auto& individuals = populations[current];
+        const auto replaceable = individuals.size() - std::min(static_cast<blt::size_t>(std::max(keep, 0)), individuals.size());
+        const auto count = std::min(replaceable, static_cast<blt::size_t>(std::clamp(fraction, 0.0, 1.0) * static_cast<double>(individuals.size())));
+        if (count == 0)
+            return;
+
+        const auto& fitness = individuals.fitness_values();
+        order.resize(fitness.size());
+        std::iota(order.begin(), order.end(), 0);
+        const auto worst_begin = order.end() - static_cast<std::ptrdiff_t>(count);
+        std::nth_element(order.begin(), worst_begin, order.end(), [&fitness](const auto a, const auto b)
+        {
+            return fitness[a] < fitness[b];
+        });
+        // restarts happen between steps and draw from a stream of their own, leaving the control stream where the step left it
+        blt::random::random_t random{rng::stream(rng::stream(seed, generation), reseed_stream)};
+        for (auto it = worst_begin; it != order.end(); ++it)
+            randomize(individuals, *it, random);
+        heap_stale = true;
+    }
+
+    std::vector<individual_t> genetic_algorithm::get_best(const blt::i32 amount)
+    {
+        const auto count = std::min(static_cast<blt::size_t>(std::max(amount, 0)), populations[current].size());
+        rank_best(count);
+
+        std::vector<individual_t> best;
+        for (blt::size_t i = 0; i < count; i++)
+            best.push_back(populations[current].load(order[i]));
+
+        return best;
+    }
+
+    void genetic_algorithm::accept_migrants(std::vector<individual_t> migrants)
+    {
+        auto& individuals = populations[current];
+        const auto count = std::min(migrants.size(), individuals.size());
+        if (count == 0)
+            return;
+
+        const auto& fitness = individuals.fitness_values();
+        order.resize(fitness.size());
+        std::iota(order.begin(), order.end(), 0);
+        const auto worst_begin = order.end() - static_cast<std::ptrdiff_t>(count);
+        std::nth_element(order.begin(), worst_begin, order.end(), [&fitness](const auto a, const auto b)
+        {
+            return fitness[a] < fitness[b];
+        });
+        for (blt::size_t i = 0; i < count; i++)
+            individuals.store(*(worst_begin + static_cast<std::ptrdiff_t>(i)), migrants[i]);
+        heap_stale = true;
+    }
+
+    blt::size_t genetic_algorithm::select(const blt::i32 k, blt::random::random_t& random, const blt::size_t draw) const
+    {
+        return selector.select(populations[current], k, random, draw);
+    }
+
+    void genetic_algorithm::crossover(const cell_t* first_parent, const cell_t* second_parent, cell_t* first_child, cell_t* second_child,
+                                      dirty_lines_t& first_dirty, dirty_lines_t& second_dirty, blt::random::random_t& random) const
+    {
+        if (encoding == encoding_t::ROW_PERMUTATION)
+        {
+            crossover_rows(first_parent, second_parent, first_child, second_child, first_dirty, second_dirty, random);
+            return;
+        }
+
+        const auto cell_count = static_cast<blt::size_t>(m_problem.board_size) * m_problem.board_size;
+
+        const auto first_begin = random.get_size_t(0, cell_count - 1);
+        const auto first_end = random.get_size_t(first_begin + 1, cell_count);
+
+        const auto size = first_end - first_begin;
+
+        const auto second_begin = random.get_size_t(0, cell_count - size);
+
+        std::memcpy(first_child, first_parent, sizeof(cell_t) * cell_count);
+        std::memcpy(first_child + first_begin, second_parent + second_begin, sizeof(cell_t) * size);
+        first_dirty.mark_range(first_begin, first_end);
+
+        if (second_child != nullptr)
+        {
+            std::memcpy(second_child, second_parent, sizeof(cell_t) * cell_count);
+            std::memcpy(second_child + second_begin, first_parent + first_begin, sizeof(cell_t) * size);
+            second_dirty.mark_range(second_begin, second_begin + size);
+        }
+    }
+
+    void genetic_algorithm::mutate(const cell_t* parent, cell_t* child, dirty_lines_t& dirty, blt::random::random_t& random) const
+    {
+
+        const auto board_size = m_problem.board_size;
+        const auto cell_count = static_cast<blt::size_t>(board_size) * board_size;
+
+        if (parent != child)
+            std::memcpy(child, parent, sizeof(cell_t) * cell_count);
+
+        if (encoding == encoding_t::ROW_PERMUTATION)
+        {
+            mutate_rows(child, dirty, random);
+            return;
+        }
 
         switch (random.get_i32(0, 3)) // NOLINT
         {
@@ -160,48 +752,139 @@ namespace sky
                 const blt::i32 points = random.get_i32(0, 5);
                 for (blt::i32 i = 0; i < points; ++i)
                 {
-                    const auto index = random.get_size_t(0, individual.board_data.size());
-                    const auto replacement = random.get_i32(m_problem.min(), m_problem.max() + 1);
-                    individual.board_data[index] = replacement;
+                    const auto index = random.get_size_t(0, cell_count);
+                    if (!m_problem.has_domains())
+                        child[index] = static_cast<cell_t>(random.get_i32(m_problem.min(), m_problem.max() + 1));
+                    else if (m_problem.is_fixed(index))
+                        continue;
+                    else
+                        child[index] = m_problem.domain_value(index, random.get_i32(0, m_problem.domain_size(index)));
+                    dirty.mark_index(index);
                 }
             }
-            return individual;
+            return;
         case 1:
             {
-                const blt::size_t s1 = random.get_size_t(0, individual.board_data.size());
+                const blt::size_t s1 = random.get_size_t(0, cell_count);
                 blt::size_t s2;
                 do
                 {
-                    s2 = random.get_size_t(0, individual.board_data.size());
+                    s2 = random.get_size_t(0, cell_count);
                 } while (s1 == s2);
-                const auto temp = individual.board_data[s1];
-                individual.board_data[s1] = individual.board_data[s2];
-                individual.board_data[s2] = temp;
+                std::swap(child[s1], child[s2]);
+                dirty.mark_index(s1);
+                dirty.mark_index(s2);
             }
-            return individual;
+            return;
         case 2:
             {
                 if (random.choice())
                 {
-                    const blt::i32 row = random.get_i32(0, individual.board_size);
-                    std::vector<blt::i32> temp;
-                    for (blt::i32 column = 0; column < individual.board_size; column++)
-                        temp.push_back(individual.get(row, column));
-                    std::shuffle(temp.begin(), temp.end(), random);
-                    for (blt::i32 column = 0; column < individual.board_size; column++)
-                        individual.set(row, column, temp[column]);
+                    const blt::i32 row = random.get_i32(0, board_size);
+                    // rows are contiguous so they can be shuffled where they are
+                    std::shuffle(child + row * board_size, child + (row + 1) * board_size, random);
+                    dirty.mark_row(row);
                 } else
                 {
-                    const blt::i32 column = random.get_i32(0, individual.board_size);
-                    std::vector<blt::i32> temp;
-                    for (blt::i32 row = 0; row < individual.board_size; row++)
-                        temp.push_back(individual.get(row, column));
-                    std::shuffle(temp.begin(), temp.end(), random);
-                    for (blt::i32 row = 0; row < individual.board_size; row++)
-                        individual.set(row, column, temp[column]);
+                    // fisher-yates over the strided column, no need to gather it into a temporary
+                    const blt::i32 column = random.get_i32(0, board_size);
+                    for (blt::i32 row = board_size - 1; row > 0; row--)
+                    {
+                        const auto other = random.get_i32(0, row + 1);
+                        std::swap(child[row * board_size + column], child[other * board_size + column]);
+                    }
+                    dirty.mark_column(column);
+                }
+            }
+            return;
+        }
+        BLT_UNREACHABLE;
+    }
+
+    void genetic_algorithm::crossover_rows(const cell_t* first_parent, const cell_t* second_parent, cell_t* first_child, cell_t* second_child,
+                                           dirty_lines_t& first_dirty, dirty_lines_t& second_dirty, blt::random::random_t& random) const
+    {
+        const auto board_size = m_problem.board_size;
+        const auto cell_count = static_cast<blt::size_t>(board_size) * board_size;
+
+        // rows only fit their own position, so the exchanged segment stays aligned
+        const auto begin = random.get_i32(0, board_size);
+        const auto end = random.get_i32(begin + 1, board_size + 1);
+        const auto offset = static_cast<blt::size_t>(begin) * board_size;
+        const auto size = static_cast<blt::size_t>(end - begin) * board_size;
+
+        std::memcpy(first_child, first_parent, cell_count);
+        std::memcpy(first_child + offset, second_parent + offset, size);
+        if (second_child != nullptr)
+        {
+            std::memcpy(second_child, second_parent, cell_count);
+            std::memcpy(second_child + offset, first_parent + offset, size);
+        }
+        for (blt::i32 row = begin; row < end; row++)
+        {
+            first_dirty.mark_row(row);
+            second_dirty.mark_row(row);
+        }
+    }
+
+    void genetic_algorithm::mutate_rows(cell_t* child, dirty_lines_t& dirty, blt::random::random_t& random) const
+    {
+        const auto board_size = m_problem.board_size;
+        const auto row_cells = [child, board_size](const blt::i32 row)
+        {
+            return child + row * board_size;
+        };
+
+        switch (random.get_i32(0, 3)) // NOLINT
+        {
+        case 0:
+            {
+                const blt::i32 rows = random.get_i32(1, 3);
+                for (blt::i32 i = 0; i < rows; ++i)
+                {
+                    const auto row = random.get_i32(0, board_size);
+                    row_tables.sample(m_problem, row, random, row_cells(row));
+                    dirty.mark_row(row);
+                }
+            }
+            return;
+        case 1:
+            {
+                // tables are sorted, so a nearby entry only differs in the last few cells of the row
+                const auto row = random.get_i32(0, board_size);
+                const auto entries = row_tables.size(row);
+                const auto index = row_tables.find(row, row_cells(row));
+                if (index == entries || entries < 2)
+                    row_tables.sample(m_problem, row, random, row_cells(row));
+                else
+                {
+                    const auto step = static_cast<blt::size_t>(random.get_i32(1, 4)) % entries;
+                    const auto next = random.choice() ? (index + step) % entries : (index + entries - step) % entries;
+                    std::memcpy(row_cells(row), row_tables.entry(row, next), board_size);
+                }
+                dirty.mark_row(row);
+            }
+            return;
+        case 2:
+            {
+                // two rows can only trade places when each permutation is also a candidate of the other row
+                const auto first = random.get_i32(0, board_size);
+                const auto second = random.get_i32(0, board_size);
+                if (first == second)
+                    return;
+                const bool fits = row_tables.enumerated(first) && row_tables.enumerated(second) &&
+                    row_tables.find(first, row_cells(second)) != row_tables.size(first) &&
+                    row_tables.find(second, row_cells(first)) != row_tables.size(second);
+                if (fits)
+                {
+                    std::swap_ranges(row_cells(first), row_cells(first) + board_size, row_cells(second));
+                    dirty.mark_row(second);
                 }
+                else
+                    row_tables.sample(m_problem, first, random, row_cells(first));
+                dirty.mark_row(first);
             }
-            return individual;
+            return;
         }
         BLT_UNREACHABLE;
     }
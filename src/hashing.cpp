@@ -0,0 +1,164 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <hashing.h>
+#include <algorithm>
+
+namespace sky
+{
+    blt::u64 zobrist_hash(const cell_t* cells, const blt::i32 board_size)
+    {
+        const auto cell_count = static_cast<blt::size_t>(board_size) * board_size;
+        blt::u64 hash = 0;
+        for (blt::size_t index = 0; index < cell_count; index++)
+            hash ^= zobrist_key(index, cells[index]);
+        return hash;
+    }
+
+    bool zobrist_update(blt::u64& hash, const cell_t* before, const cell_t* after, const dirty_lines_t& dirty)
+    {
+        const auto size = static_cast<blt::size_t>(dirty.board_size);
+        bool changed = false;
+        for (blt::size_t row = 0; row < size; row++)
+        {
+            if (!dirty.rows[row])
+                continue;
+            for (blt::size_t column = 0; column < size; column++)
+            {
+                const auto index = row * size + column;
+                if (!dirty.columns[column] || before[index] == after[index])
+                    continue;
+                hash ^= zobrist_key(index, before[index]) ^ zobrist_key(index, after[index]);
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    void fitness_cache_t::resize(const blt::size_t entries, const blt::i32 board_size)
+    {
+        slots.reset();
+        scores.reset();
+        mask = 0;
+        hits = 0;
+        misses = 0;
+        if (entries == 0)
+            return;
+
+        blt::size_t size = 1;
+        while (size < entries)
+            size <<= 1;
+        line_count = static_cast<blt::size_t>(board_size) * 2;
+        slots = std::make_unique<slot_t[]>(size);
+        scores = std::make_unique<std::atomic<blt::i32>[]>(size * line_count);
+        mask = size - 1;
+    }
+
+    bool fitness_cache_t::lookup(const blt::u64 hash, blt::i32* line_scores, blt::i32& fitness) const
+    {
+        const auto& slot = slots[hash & mask];
+        const auto sequence = slot.sequence.load(std::memory_order_acquire);
+        if ((sequence & 1) != 0 || slot.hash.load(std::memory_order_relaxed) != hash)
+        {
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        // read into scratch first, a torn read must leave the caller's scores untouched. cell_t caps boards at 255 lines a side
+        blt::i32 read[2 * 256];
+        const auto* cached = scores.get() + (hash & mask) * line_count;
+        for (blt::size_t i = 0; i < line_count; i++)
+            read[i] = cached[i].load(std::memory_order_relaxed);
+        const auto cached_fitness = slot.fitness.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+        {
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        std::copy_n(read, line_count, line_scores);
+        fitness = cached_fitness;
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void fitness_cache_t::insert(const blt::u64 hash, const blt::i32* line_scores, const blt::i32 fitness)
+    {
+        auto& slot = slots[hash & mask];
+        auto sequence = slot.sequence.load(std::memory_order_relaxed);
+        if ((sequence & 1) != 0 || !slot.sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_relaxed))
+            return;
+        std::atomic_thread_fence(std::memory_order_release);
+
+        auto* cached = scores.get() + (hash & mask) * line_count;
+        for (blt::size_t i = 0; i < line_count; i++)
+            cached[i].store(line_scores[i], std::memory_order_relaxed);
+        slot.fitness.store(fitness, std::memory_order_relaxed);
+        slot.hash.store(hash, std::memory_order_relaxed);
+
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    void hash_counter_t::reset(const blt::size_t members)
+    {
+        blt::size_t size = 1;
+        while (size < members * 2)
+            size <<= 1;
+        slots.assign(std::max(size, slots.size()), slot_t{});
+        mask = slots.size() - 1;
+    }
+
+    blt::size_t hash_counter_t::find(const blt::u64 hash) const
+    {
+        auto index = hash & mask;
+        while (slots[index].count != 0 && slots[index].hash != hash)
+            index = (index + 1) & mask;
+        return index;
+    }
+
+    void hash_counter_t::add(const blt::u64 hash)
+    {
+        auto& slot = slots[find(hash)];
+        slot.hash = hash;
+        ++slot.count;
+    }
+
+    void hash_counter_t::remove(const blt::u64 hash)
+    {
+        auto index = find(hash);
+        if (--slots[index].count != 0)
+            return;
+        // shift the rest of the probe run back so lookups never stop early at the freed slot
+        for (auto next = (index + 1) & mask; slots[next].count != 0; next = (next + 1) & mask)
+        {
+            const auto home = slots[next].hash & mask;
+            // the entry can fill the hole only if the hole lies between its home slot and where it sits now
+            if (((next - home) & mask) >= ((next - index) & mask))
+            {
+                slots[index] = slots[next];
+                slots[next].count = 0;
+                index = next;
+            }
+        }
+    }
+
+    bool hash_counter_t::contains(const blt::u64 hash) const
+    {
+        return slots[find(hash)].count != 0;
+    }
+}
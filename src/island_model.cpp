@@ -0,0 +1,176 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <island_model.h>
+#include <algorithm>
+#include <thread>
+
+namespace sky
+{
+    island_model_t::island_model_t(const problem_t& problem, const std::vector<island_config_t>& configs, const blt::i32 migration_interval,
+                                   const blt::i32 migrant_count, const migration_topology_t topology, const blt::u64 seed):
+        migration_interval(std::max(migration_interval, 1)), migrant_count(migrant_count), topology(topology)
+    {
+        for (blt::size_t i = 0; i < configs.size(); i++)
+        {
+            const auto& config = configs[i];
+            islands.push_back(std::make_unique<genetic_algorithm>(problem, config.individual_count, config.crossover_rate, config.mutation_rate,
+                                                                  rng::stream(seed, i)));
+            mailboxes.push_back(std::make_unique<migrant_mailbox_t>());
+        }
+        outgoing.resize(islands.size());
+        outgoing_targets.resize(islands.size());
+        island_solved = std::make_unique<std::atomic_bool[]>(islands.size());
+    }
+
+    blt::i32 island_model_t::run(const blt::i32 generations, const blt::i32 elites, const blt::i32 k)
+    {
+        solved = false;
+
+        std::vector<blt::i32> generations_run(islands.size(), 0);
+        island_barrier_t barrier{islands.size()};
+        for (blt::size_t i = 0; i < islands.size(); i++)
+            island_solved[i] = false;
+        std::vector<std::thread> threads;
+        threads.reserve(islands.size());
+        for (blt::size_t i = 0; i < islands.size(); i++)
+        {
+            threads.emplace_back([this, &generations_run, &barrier, i, generations, elites, k]()
+            {
+                if (lockstep)
+                    generations_run[i] = run_island_lockstep(i, generations, elites, k, barrier);
+                else
+                    generations_run[i] = run_island(i, generations, elites, k);
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        // whatever is left in the mailboxes is stale now
+        for (const auto& mailbox : mailboxes)
+            (void) mailbox->take();
+
+        if (generations_run.empty())
+            return 0;
+        return *std::max_element(generations_run.begin(), generations_run.end());
+    }
+
+    blt::i32 island_model_t::run_island(const blt::size_t index, const blt::i32 generations, const blt::i32 elites, const blt::i32 k)
+    {
+        auto& island = *islands[index];
+        const bool can_migrate = islands.size() > 1 && migrant_count > 0;
+
+        for (blt::i32 generation = 0; generation < generations; generation++)
+        {
+            if (solved.load(std::memory_order_relaxed))
+                return generation;
+
+            island.run_step(elites, k);
+
+            if (island.best_fitness() == 0)
+            {
+                solved.store(true, std::memory_order_relaxed);
+                return generation + 1;
+            }
+
+            if (!can_migrate || (generation + 1) % migration_interval != 0)
+                continue;
+
+            // only copy boards out on generations that actually send them
+            mailboxes[migration_target(index)]->post(std::make_unique<std::vector<individual_t>>(island.get_best(migrant_count)));
+
+            if (auto migrants = mailboxes[index]->take())
+                island.accept_migrants(std::move(*migrants));
+        }
+        return generations;
+    }
+
+    blt::i32 island_model_t::run_island_lockstep(const blt::size_t index, const blt::i32 generations, const blt::i32 elites, const blt::i32 k,
+                                                 island_barrier_t& barrier)
+    {
+        auto& island = *islands[index];
+        const bool can_migrate = islands.size() > 1 && migrant_count > 0;
+
+        // every island goes through the same number of epochs and barriers, an island that solved its puzzle just stops stepping
+        blt::i32 generation = 0;
+        for (blt::i32 epoch_begin = 0; epoch_begin < generations; epoch_begin += migration_interval)
+        {
+            const auto epoch_end = std::min(generations, epoch_begin + migration_interval);
+            for (; generation < epoch_end && !island_solved[index].load(std::memory_order_relaxed); generation++)
+            {
+                island.run_step(elites, k);
+                if (island.best_fitness() == 0)
+                    island_solved[index].store(true, std::memory_order_relaxed);
+            }
+
+            barrier.arrive_and_wait();
+            bool any_solved = false;
+            for (blt::size_t i = 0; i < islands.size(); i++)
+                any_solved |= island_solved[i].load(std::memory_order_relaxed);
+            if (any_solved)
+            {
+                solved = true;
+                return generation;
+            }
+            const bool migrate = can_migrate && epoch_end < generations;
+            if (migrate)
+            {
+                outgoing[index] = island.get_best(migrant_count);
+                outgoing_targets[index] = migration_target(index);
+            }
+            // nobody steps (or touches the solved flags) again until every island has read them and posted its migrants
+            barrier.arrive_and_wait();
+            if (!migrate)
+                continue;
+
+            // migrants from every sender aimed at this island, always taken in sender order
+            std::vector<individual_t> migrants;
+            for (blt::size_t sender = 0; sender < islands.size(); sender++)
+            {
+                if (sender != index && outgoing_targets[sender] == index)
+                    migrants.insert(migrants.end(), outgoing[sender].begin(), outgoing[sender].end());
+            }
+            island.accept_migrants(std::move(migrants));
+        }
+        return generation;
+    }
+
+    blt::size_t island_model_t::migration_target(const blt::size_t index) const
+    {
+        if (topology == migration_topology_t::RING)
+            return (index + 1) % islands.size();
+        const auto offset = islands[index]->get_random().get_size_t(1, islands.size());
+        return (index + offset) % islands.size();
+    }
+
+    std::vector<individual_t> island_model_t::get_best(const blt::i32 amount)
+    {
+        std::vector<individual_t> best;
+        for (const auto& island : islands)
+        {
+            for (auto& individual : island->get_best(amount))
+                best.push_back(std::move(individual));
+        }
+        std::sort(best.begin(), best.end(), [](const auto& a, const auto& b)
+        {
+            return a.fitness < b.fitness;
+        });
+        if (best.size() > static_cast<blt::size_t>(amount))
+            best.resize(amount);
+        return best;
+    }
+}
@@ -0,0 +1,182 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <local_search.h>
+#include <fitness_kernel.h>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace sky
+{
+    namespace
+    {
+        struct swap_move_t
+        {
+            blt::i32 row;
+            blt::i32 first, second;
+        };
+
+        // applies the swap and returns the change in fitness, without touching the cached scores
+        blt::i32 try_swap(const problem_t& problem, cell_t* cells, const blt::i32* line_scores, const swap_move_t& move,
+                          const fitness_kernel_t kernel)
+        {
+            const auto size = problem.board_size;
+            std::swap(cells[move.row * size + move.first], cells[move.row * size + move.second]);
+            const auto before = line_scores[move.row] + line_scores[size + move.first] + line_scores[size + move.second];
+            const auto after = score_row(problem, cells, move.row, kernel) + score_column(problem, cells, move.first, kernel) +
+                score_column(problem, cells, move.second, kernel);
+            return after - before;
+        }
+
+        void commit_swap(const problem_t& problem, population_t& population, const blt::size_t index, const swap_move_t& move,
+                         const fitness_kernel_t kernel)
+        {
+            auto* cells = population.cells(index);
+            auto* line_scores = population.line_scores(index);
+            const auto size = problem.board_size;
+            const auto before = line_scores[move.row] + line_scores[size + move.first] + line_scores[size + move.second];
+            line_scores[move.row] = score_row(problem, cells, move.row, kernel);
+            line_scores[size + move.first] = score_column(problem, cells, move.first, kernel);
+            line_scores[size + move.second] = score_column(problem, cells, move.second, kernel);
+            population.fitness(index) += line_scores[move.row] + line_scores[size + move.first] + line_scores[size + move.second] - before;
+        }
+
+        bool movable(const problem_t& problem, const cell_t* cells, const swap_move_t& move)
+        {
+            const auto size = problem.board_size;
+            const auto first = static_cast<blt::size_t>(move.row * size + move.first);
+            const auto second = static_cast<blt::size_t>(move.row * size + move.second);
+            return cells[first] != cells[second] && !problem.is_fixed(first) && !problem.is_fixed(second);
+        }
+    }
+
+    blt::i32 hill_climb(const problem_t& problem, population_t& population, const blt::size_t index, const fitness_kernel_t kernel,
+                        blt::random::random_t& random, const blt::i32 max_moves)
+    {
+        const auto size = problem.board_size;
+        if (size < 2)
+            return 0;
+        const auto starting_fitness = population.fitness(index);
+        auto* cells = population.cells(index);
+        const auto pairs = size * (size - 1) / 2;
+        const auto neighbourhood = size * pairs;
+
+        blt::i32 moves = 0;
+        bool improved = true;
+        while (improved && moves < max_moves && population.fitness(index) > 0)
+        {
+            improved = false;
+            // walk the whole neighbourhood from a random starting move, wrapping around
+            const auto start = random.get_i32(0, neighbourhood);
+            for (blt::i32 step = 0; step < neighbourhood && moves < max_moves; step++)
+            {
+                const auto id = (start + step) % neighbourhood;
+                auto pair = id % pairs;
+                swap_move_t move{id / pairs, 0, 0};
+                // unrank the pair index into first < second
+                while (pair >= size - 1 - move.first)
+                {
+                    pair -= size - 1 - move.first;
+                    ++move.first;
+                }
+                move.second = move.first + 1 + pair;
+
+                if (!movable(problem, cells, move))
+                    continue;
+                ++moves;
+                if (try_swap(problem, cells, population.line_scores(index), move, kernel) < 0)
+                {
+                    commit_swap(problem, population, index, move, kernel);
+                    improved = true;
+                    break;
+                }
+                std::swap(cells[move.row * size + move.first], cells[move.row * size + move.second]);
+            }
+        }
+        return starting_fitness - population.fitness(index);
+    }
+
+    blt::i32 tabu_search(const problem_t& problem, population_t& population, const blt::size_t index, const fitness_kernel_t kernel,
+                         const blt::i32 iterations, const blt::i32 tenure)
+    {
+        const auto size = problem.board_size;
+        if (size < 2)
+            return 0;
+        const auto cell_count = static_cast<blt::size_t>(size) * size;
+        const auto starting_fitness = population.fitness(index);
+        auto* cells = population.cells(index);
+
+        thread_local std::vector<blt::i32> tabu_until;
+        thread_local std::vector<cell_t> best_cells;
+        thread_local std::vector<blt::i32> best_scores;
+        tabu_until.assign(cell_count, 0);
+        best_cells.assign(cells, cells + cell_count);
+        best_scores.assign(population.line_scores(index), population.line_scores(index) + size * 2);
+        auto best_fitness = starting_fitness;
+
+        for (blt::i32 iteration = 1; iteration <= iterations && best_fitness > 0; iteration++)
+        {
+            swap_move_t chosen{-1, 0, 0};
+            blt::i32 chosen_delta = std::numeric_limits<blt::i32>::max();
+            for (blt::i32 row = 0; row < size; row++)
+            {
+                for (blt::i32 first = 0; first < size; first++)
+                {
+                    for (blt::i32 second = first + 1; second < size; second++)
+                    {
+                        const swap_move_t move{row, first, second};
+                        if (!movable(problem, cells, move))
+                            continue;
+                        const auto delta = try_swap(problem, cells, population.line_scores(index), move, kernel);
+                        std::swap(cells[row * size + first], cells[row * size + second]);
+
+                        const bool tabu = tabu_until[row * size + first] >= iteration || tabu_until[row * size + second] >= iteration;
+                        // aspiration, a tabu move is still allowed if it beats the best board seen
+                        if (tabu && population.fitness(index) + delta >= best_fitness)
+                            continue;
+                        if (delta < chosen_delta)
+                        {
+                            chosen = move;
+                            chosen_delta = delta;
+                        }
+                    }
+                }
+            }
+            if (chosen.row < 0)
+                break;
+
+            std::swap(cells[chosen.row * size + chosen.first], cells[chosen.row * size + chosen.second]);
+            commit_swap(problem, population, index, chosen, kernel);
+            tabu_until[chosen.row * size + chosen.first] = iteration + tenure;
+            tabu_until[chosen.row * size + chosen.second] = iteration + tenure;
+
+            if (population.fitness(index) < best_fitness)
+            {
+                best_fitness = population.fitness(index);
+                best_cells.assign(cells, cells + cell_count);
+                best_scores.assign(population.line_scores(index), population.line_scores(index) + size * 2);
+            }
+        }
+
+        std::copy(best_cells.begin(), best_cells.end(), cells);
+        std::copy(best_scores.begin(), best_scores.end(), population.line_scores(index));
+        population.fitness(index) = best_fitness;
+        return starting_fitness - best_fitness;
+    }
+}
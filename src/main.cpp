@@ -1,51 +1,47 @@
+#include <batch.h>
+#include <checkpoint.h>
+#include <corpus.h>
+#include <run_controller.h>
 #include <genetic_algorithm.h>
-#include <blt/gfx/window.h>
-#include "blt/gfx/renderer/resource_manager.h"
-#include "blt/gfx/renderer/batch_2d_renderer.h"
-#include "blt/gfx/renderer/camera.h"
 #include <blt/parse/argparse.h>
+#include <blt/std/logging.h>
 #include <skyscrapers.h>
-#include <imgui.h>
-
-blt::gfx::matrix_state_manager global_matrices;
-blt::gfx::resource_manager resources;
-blt::gfx::batch_renderer_2d renderer_2d(resources, global_matrices);
-blt::gfx::first_person_camera camera;
-
-void init(const blt::gfx::window_data&)
-{
-    using namespace blt::gfx;
-
-
-    global_matrices.create_internals();
-    resources.load_resources();
-    renderer_2d.create();
-}
-
-void update(const blt::gfx::window_data& data)
-{
-    global_matrices.update_perspectives(data.width, data.height, 90, 0.1, 2000);
-
-    camera.update();
-    camera.update_view(global_matrices);
-    global_matrices.update();
-
-    renderer_2d.render(data.width, data.height);
-}
-
-void destroy(const blt::gfx::window_data&)
-{
-    global_matrices.cleanup();
-    resources.cleanup();
-    renderer_2d.cleanup();
-    blt::gfx::cleanup();
-}
+#include <solver.h>
+#include <telemetry.h>
+#include <fstream>
+#include <iostream>
+#include <memory>
 
 int main(int argc, const char** argv)
 {
     blt::arg_parse parser;
 
-    parser.addArgument(blt::arg_builder("file").build());
+    parser.addArgument(blt::arg_builder("file").setHelp("Skyscraper file, or a directory / manifest / packed corpus of them with --batch").build());
+    parser.addArgument(blt::arg_builder("--batch").setAction(blt::arg_action_t::STORE_TRUE)
+                       .setHelp("Solve every puzzle of a directory or manifest, writing a JSON line per puzzle").build());
+    parser.addArgument(blt::arg_builder("--pack").setDefault("")
+                       .setHelp("Packs the puzzles of a directory or manifest into this corpus file (see corpus.h) and exits").build());
+    parser.addArgument(blt::arg_builder("--output").setDefault("-").setHelp("File the batch results are written to, - for stdout").build());
+    parser.addArgument(blt::arg_builder("--workers").setDefault("0").setHelp("Puzzles solved concurrently in batch mode, 0 for all cores").build());
+    parser.addArgument(blt::arg_builder("--population").setDefault("500").build());
+    parser.addArgument(blt::arg_builder("--generations").setDefault("500").setHelp("Generation budget per puzzle").build());
+    parser.addArgument(blt::arg_builder("--time-limit").setDefault("0").setHelp("Seconds allowed per puzzle, 0 for no limit").build());
+    parser.addArgument(blt::arg_builder("--telemetry").setDefault("").setHelp("File per generation counters are streamed to").build());
+    parser.addArgument(blt::arg_builder("--telemetry-format").setDefault("csv").setHelp("csv or binary").build());
+    parser.addArgument(blt::arg_builder("--checkpoint").setDefault("").setHelp("File the run is periodically saved to").build());
+    parser.addArgument(blt::arg_builder("--checkpoint-interval").setDefault("50").setHelp("Generations between checkpoints").build());
+    parser.addArgument(blt::arg_builder("--resume").setDefault("").setHelp("Checkpoint to continue from instead of a fresh population").build());
+    parser.addArgument(blt::arg_builder("--encoding").setDefault("cells")
+                       .setHelp("cells, or rows to build boards from clue consistent row permutations").build());
+    parser.addArgument(blt::arg_builder("--replacement").setDefault("generational")
+                       .setHelp("generational, crowding or sharing, how children compete with their parents for a slot").build());
+    parser.addArgument(blt::arg_builder("--steady").setDefault("0")
+                       .setHelp("Children bred and inserted in place per step, 0 builds whole generations").build());
+    parser.addArgument(blt::arg_builder("--steady-victim").setDefault("worst").setHelp("worst or tournament, who a steady state child replaces").build());
+    parser.addArgument(blt::arg_builder("--evaluation").setDefault("inline")
+                       .setHelp("inline, or batched to score each worker's children together across SIMD lanes").build());
+    parser.addArgument(blt::arg_builder("--seed").setDefault("0").setHelp("Seed of every random decision of the run, 0 picks one").build());
+    parser.addArgument(blt::arg_builder("--policy").setDefault("adapt").setHelp("Reaction to stagnation: none, adapt or restart").build());
 
     auto args = parser.parse_args(argc, argv);
 
@@ -56,6 +52,95 @@ int main(int argc, const char** argv)
     }
 
     const auto file = args.get<std::string>("file");
+    const auto population = std::stoi(args.get<std::string>("--population"));
+
+    sky::run_controller_config_t control;
+    control.max_generations = std::stoi(args.get<std::string>("--generations"));
+    control.time_limit_seconds = std::stod(args.get<std::string>("--time-limit"));
+    const auto policy = args.get<std::string>("--policy");
+    if (policy == "none")
+        control.policy = sky::restart_policy_t::NONE;
+    else if (policy == "restart")
+        control.policy = sky::restart_policy_t::PARTIAL_RESTART;
+    else if (policy != "adapt")
+        BLT_WARN("Unknown policy '%s', adapting rates instead", policy.c_str());
+
+    auto seed = std::stoull(args.get<std::string>("--seed"));
+    if (seed == 0)
+        seed = sky::rng::random_seed();
+    const auto encoding = args.get<std::string>("--encoding") == "rows" ? sky::encoding_t::ROW_PERMUTATION : sky::encoding_t::CELLS;
+
+    sky::replacement_config_t replacement;
+    const auto replacement_mode = args.get<std::string>("--replacement");
+    if (replacement_mode == "crowding")
+        replacement.mode = sky::replacement_t::DETERMINISTIC_CROWDING;
+    else if (replacement_mode == "sharing")
+        replacement.mode = sky::replacement_t::FITNESS_SHARING;
+    else if (replacement_mode != "generational")
+        BLT_WARN("Unknown replacement '%s', keeping every child", replacement_mode.c_str());
+
+    const auto evaluation = args.get<std::string>("--evaluation") == "batched" ? sky::evaluation_t::BATCHED : sky::evaluation_t::INLINE;
+
+    sky::steady_state_config_t steady;
+    steady.births = std::stoul(args.get<std::string>("--steady"));
+    if (args.get<std::string>("--steady-victim") == "tournament")
+        steady.victim = sky::steady_victim_t::TOURNAMENT_LOSER;
+
+    if (const auto pack = args.get<std::string>("--pack"); !pack.empty())
+    {
+        const auto files = sky::collect_batch_files(file);
+        const auto packed = sky::pack_corpus(pack, files);
+        if (packed < 0)
+            return EXIT_FAILURE;
+        BLT_INFO("Packed %ld of %lu puzzles into '%s'", static_cast<long>(packed), static_cast<unsigned long>(files.size()), pack.c_str());
+        return EXIT_SUCCESS;
+    }
+
+    if (args.contains("--batch"))
+    {
+        sky::batch_config_t config;
+        config.workers = std::stoul(args.get<std::string>("--workers"));
+        config.individual_count = population;
+        config.control = control;
+        config.encoding = encoding;
+        config.replacement = replacement;
+        config.steady = steady;
+        config.evaluation = evaluation;
+        config.seed = seed;
+
+        const auto output = args.get<std::string>("--output");
+        std::ofstream output_file;
+        if (output != "-")
+        {
+            output_file.open(output);
+            if (!output_file)
+            {
+                BLT_WARN("Unable to open output file '%s'", output.c_str());
+                return EXIT_FAILURE;
+            }
+        }
+
+        auto& out = output == "-" ? std::cout : output_file;
+        blt::size_t solved, total;
+        if (sky::corpus_t::is_corpus(file))
+        {
+            auto corpus = sky::corpus_t::open(file);
+            if (!corpus)
+                return EXIT_FAILURE;
+            total = corpus.value().size();
+            solved = sky::run_batch(corpus.value(), file, config, out);
+        }
+        else
+        {
+            const auto files = sky::collect_batch_files(file);
+            total = files.size();
+            solved = sky::run_batch(files, config, out);
+        }
+        // keep stdout pure JSON lines when results are streamed there
+        if (output != "-")
+            BLT_INFO("Solved %lu of %lu puzzles", static_cast<unsigned long>(solved), static_cast<unsigned long>(total));
+        return solved == total ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 
     auto problem = sky::problem_from_file(file);
 
@@ -68,19 +153,76 @@ int main(int argc, const char** argv)
     const auto& problem_d = problem.value();
     problem_d.print();
 
-    sky::genetic_algorithm ga{problem_d, 500, 0.8, 0.1};
+    std::unique_ptr<sky::genetic_algorithm> ga;
+    if (const auto resume = args.get<std::string>("--resume"); !resume.empty())
+    {
+        auto checkpoint = sky::checkpoint_t::open(resume);
+        if (!checkpoint)
+        {
+            BLT_WARN("Unable to resume from checkpoint!");
+            return EXIT_FAILURE;
+        }
+        ga = std::make_unique<sky::genetic_algorithm>(checkpoint.value());
+        BLT_TRACE("Resuming from generation %lu", static_cast<unsigned long>(ga->get_generation()));
+    } else
+    {
+        ga = std::make_unique<sky::genetic_algorithm>(problem_d, population, 0.8, 0.1, seed);
+        ga->set_encoding(encoding);
+        ga->set_replacement(replacement);
+        ga->set_steady_state(steady);
+        ga->set_evaluation(evaluation);
+        BLT_TRACE("Seed %llu", static_cast<unsigned long long>(seed));
+    }
+
+    // generations are only recorded when asked for, the sink writes them from its own thread
+    std::unique_ptr<sky::telemetry_ring_t> telemetry;
+    std::unique_ptr<sky::telemetry_sink_t> telemetry_sink;
+    if (const auto telemetry_path = args.get<std::string>("--telemetry"); !telemetry_path.empty())
+    {
+        const auto format = args.get<std::string>("--telemetry-format") == "binary" ? sky::telemetry_format_t::BINARY : sky::telemetry_format_t::CSV;
+        telemetry = std::make_unique<sky::telemetry_ring_t>();
+        telemetry_sink = std::make_unique<sky::telemetry_sink_t>(*telemetry, telemetry_path, format);
+        ga->set_telemetry(telemetry.get());
+    }
+
+    sky::run_controller_t controller{control};
 
-    for (blt::i32 i = 0; i < 500; i++)
+    std::unique_ptr<sky::checkpoint_writer_t> checkpoints;
+    if (const auto checkpoint_path = args.get<std::string>("--checkpoint"); !checkpoint_path.empty())
     {
-        ga.run_step(2, 5);
-        BLT_TRACE("Ran GP generation %d with average fitness %lf", i, ga.average_fitness());
-        auto best = ga.get_best(1);
-        BLT_TRACE("Best individual has fitness: %d", best.front().fitness);
+        checkpoints = std::make_unique<sky::checkpoint_writer_t>(checkpoint_path);
+        const auto interval = std::max(1, std::stoi(args.get<std::string>("--checkpoint-interval")));
+        controller.set_generation_callback([&ga, &checkpoints, interval](const sky::generation_stats_t& stats)
+        {
+            if (stats.generation % interval == 0)
+                checkpoints->save(*ga);
+        });
     }
 
-    auto best = ga.get_best(1);
-    BLT_TRACE("Best individual: %d", best.front().solution.fitness(problem_d));
-    best.front().solution.print(problem_d);
+    const auto report = controller.run(*ga, 2, 5);
+    if (checkpoints)
+        checkpoints->save(*ga);
+    checkpoints.reset();
+    ga->set_telemetry(nullptr);
+    telemetry_sink.reset();
+    BLT_TRACE("Stopped after %d generations (%lf seconds), %d stagnations, %d restarts", report.generations, report.seconds, report.stagnations,
+              report.restarts);
+
+    auto best = ga->get_best(1);
+    BLT_TRACE("Best individual: %d", best.front().solution.fitness(ga->get_problem()));
+    best.front().solution.print(ga->get_problem());
+
+    if (best.front().fitness != 0 && ga->get_problem().board_size <= sky::backtracking_solver_t::fast_path_board_size)
+    {
+        sky::backtracking_solver_t solver{ga->get_problem()};
+        if (auto exact = solver.solve())
+        {
+            BLT_TRACE("Exact solution (%lu nodes):", static_cast<unsigned long>(solver.get_nodes_visited()));
+            exact.value().print(ga->get_problem());
+        }
+        else
+            BLT_WARN("Puzzle has no solution!");
+    }
 
     BLT_TRACE("----------");
 
@@ -93,7 +235,4 @@ int main(int argc, const char** argv)
     BLT_TRACE(sky::make_test_solution_bad1().fitness(test));
     BLT_TRACE(sky::make_test_solution_bad2().fitness(test));
     BLT_TRACE(sky::make_test_solution_bad3().fitness(test));
-
-
-    // blt::gfx::init(blt::gfx::window_data{"My Sexy Window", init, update, destroy}.setSyncInterval(1));
 }
\ No newline at end of file
@@ -0,0 +1,161 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <population.h>
+#include <fitness_kernel.h>
+#include <hashing.h>
+#include <cstring>
+
+namespace sky
+{
+    void individual_t::evaluate(const problem_t& problem, const fitness_kernel_t kernel)
+    {
+        line_scores.resize(solution.board_size * 2);
+        fitness = score_lines(problem, solution.board_data.data(), line_scores.data(), kernel);
+    }
+
+    void individual_t::rescore(const problem_t& problem, const dirty_lines_t& dirty, const fitness_kernel_t kernel)
+    {
+        rescore_lines(problem, solution.board_data.data(), line_scores.data(), fitness, dirty, kernel);
+    }
+
+    void population_t::resize(const blt::i32 board_size, const blt::size_t count)
+    {
+        const auto cells_per_board = static_cast<blt::size_t>(board_size) * board_size;
+        this->board_size = board_size;
+        this->count = count;
+        board_stride = (cells_per_board + cache_line_size - 1) / cache_line_size * cache_line_size;
+        m_cells.resize(board_stride * count);
+        m_line_scores.resize(static_cast<blt::size_t>(board_size) * 2 * count);
+        m_fitness.resize(count);
+        m_hashes.resize(count);
+    }
+
+    void population_t::shrink_to_fit()
+    {
+        m_cells.shrink_to_fit();
+        m_line_scores.shrink_to_fit();
+        m_fitness.shrink_to_fit();
+        m_hashes.shrink_to_fit();
+    }
+
+    void population_t::copy(const blt::size_t index, const population_t& from, const blt::size_t from_index)
+    {
+        std::memcpy(cells(index), from.cells(from_index), static_cast<blt::size_t>(board_size) * board_size);
+        std::memcpy(line_scores(index), from.line_scores(from_index), sizeof(blt::i32) * board_size * 2);
+        m_fitness[index] = from.m_fitness[from_index];
+        m_hashes[index] = from.m_hashes[from_index];
+    }
+
+    void population_t::copy_scores(const blt::size_t index, const population_t& from, const blt::size_t from_index)
+    {
+        std::memcpy(line_scores(index), from.line_scores(from_index), sizeof(blt::i32) * board_size * 2);
+        m_fitness[index] = from.m_fitness[from_index];
+        m_hashes[index] = from.m_hashes[from_index];
+    }
+
+    void population_t::store(const blt::size_t index, const individual_t& individual)
+    {
+        std::memcpy(cells(index), individual.solution.board_data.data(), individual.solution.board_data.size());
+        std::memcpy(line_scores(index), individual.line_scores.data(), sizeof(blt::i32) * board_size * 2);
+        m_fitness[index] = individual.fitness;
+        rehash(index);
+    }
+
+    void population_t::assign(const blt::size_t index, const cell_t* board, const blt::i32* scores, const blt::i32 fitness)
+    {
+        std::memcpy(cells(index), board, static_cast<blt::size_t>(board_size) * board_size);
+        std::memcpy(line_scores(index), scores, sizeof(blt::i32) * board_size * 2);
+        m_fitness[index] = fitness;
+        rehash(index);
+    }
+
+    individual_t population_t::load(const blt::size_t index) const
+    {
+        individual_t individual;
+        individual.solution = solution_t{board_size};
+        std::memcpy(individual.solution.board_data.data(), cells(index), individual.solution.board_data.size());
+        individual.line_scores.assign(line_scores(index), line_scores(index) + board_size * 2);
+        individual.fitness = m_fitness[index];
+        return individual;
+    }
+
+    void population_t::evaluate(const blt::size_t index, const problem_t& problem, const fitness_kernel_t kernel)
+    {
+        m_fitness[index] = score_lines(problem, cells(index), line_scores(index), kernel);
+        rehash(index);
+    }
+
+    void population_t::rescore(const blt::size_t index, const problem_t& problem, const dirty_lines_t& dirty, const fitness_kernel_t kernel)
+    {
+        rescore_lines(problem, cells(index), line_scores(index), m_fitness[index], dirty, kernel);
+    }
+
+    void population_t::evaluate_batch(const blt::size_t* indexes, const blt::size_t count, const problem_t& problem)
+    {
+        thread_local std::vector<const cell_t*> boards;
+        thread_local std::vector<blt::i32*> scores;
+        thread_local std::vector<blt::i32> fitness;
+        // batches vary in size, a batch never holds more than the population so growing to that once is enough
+        boards.reserve(size());
+        scores.reserve(size());
+        fitness.reserve(size());
+        boards.resize(count);
+        scores.resize(count);
+        fitness.resize(count);
+        for (blt::size_t i = 0; i < count; i++)
+        {
+            boards[i] = cells(indexes[i]);
+            scores[i] = line_scores(indexes[i]);
+        }
+        kernel::batch_line_scores(problem, boards.data(), count, fitness.data(), scores.data());
+        for (blt::size_t i = 0; i < count; i++)
+            m_fitness[indexes[i]] = fitness[i];
+    }
+
+    bool population_t::update_hash(const blt::size_t index, const cell_t* parent, const dirty_lines_t& dirty)
+    {
+        return zobrist_update(m_hashes[index], parent, cells(index), dirty);
+    }
+
+    void population_t::rehash(const blt::size_t index)
+    {
+        m_hashes[index] = zobrist_hash(cells(index), board_size);
+    }
+
+    blt::size_t population_t::distance(const blt::size_t index, const cell_t* board) const
+    {
+        return kernel::hamming_distance(cells(index), board, static_cast<blt::size_t>(board_size) * board_size);
+    }
+
+    double population_t::diversity(const blt::size_t pairs, blt::random::random_t& random) const
+    {
+        if (count < 2 || pairs == 0)
+            return 0;
+        const auto cell_count = static_cast<blt::size_t>(board_size) * board_size;
+        blt::size_t differing = 0;
+        for (blt::size_t pair = 0; pair < pairs; pair++)
+        {
+            const auto first = random.get_size_t(0, count);
+            auto second = random.get_size_t(0, count - 1);
+            if (second >= first)
+                ++second;
+            differing += distance(first, cells(second));
+        }
+        return static_cast<double>(differing) / static_cast<double>(pairs * cell_count);
+    }
+}
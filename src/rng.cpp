@@ -0,0 +1,41 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <rng.h>
+#include <random>
+
+namespace sky::rng
+{
+    blt::u64 random_seed()
+    {
+        std::random_device device;
+        return static_cast<blt::u64>(device()) << 32 | device();
+    }
+
+    void fill(const blt::u64 key, const blt::u64 counter, blt::u64* out, const blt::size_t count)
+    {
+        for (blt::size_t i = 0; i < count; i++)
+            out[i] = at(key, counter + i);
+    }
+
+    void fill_cells(const blt::u64 key, const blt::u64 counter, cell_t* out, const blt::size_t count, const blt::i32 min, const blt::i32 max)
+    {
+        const auto range = static_cast<blt::u32>(max - min + 1);
+        for (blt::size_t i = 0; i < count; i++)
+            out[i] = static_cast<cell_t>(min + static_cast<blt::i32>(bounded(at(key, counter + i), range)));
+    }
+}
@@ -0,0 +1,218 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <row_table.h>
+#include <blt/std/logging.h>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace sky
+{
+    namespace
+    {
+        // depth first search over the permutations of a row, placing cells left to right. the left clue is checked as cells are placed
+        // (pruning when the remaining taller values can no longer be seen), the right clue once the tallest building is placed and at the end
+        struct row_search_t
+        {
+            blt::i32 size = 0;
+            blt::i32 left = 0, right = 0;
+            // allowed[position * (size + 1) + value]
+            std::vector<bool> allowed;
+            std::vector<bool> used;
+            std::vector<cell_t> current;
+            // candidate order of each depth, only shuffled when sampling
+            std::vector<cell_t> order;
+            blt::u64 nodes = 0;
+            blt::u64 node_limit = 0;
+
+            row_search_t() = default;
+
+            row_search_t(const problem_t& problem, const blt::i32 row, const blt::u64 node_limit)
+            {
+                reset(problem, row, node_limit);
+            }
+
+            // sets the search up for another row, reusing the buffers of the last one
+            void reset(const problem_t& problem, const blt::i32 row, const blt::u64 new_node_limit)
+            {
+                size = problem.board_size;
+                left = problem.left[row];
+                right = problem.right[row];
+                allowed.assign(static_cast<blt::size_t>(size) * (size + 1), !problem.has_domains());
+                used.assign(size + 1, false);
+                current.resize(size);
+                order.resize(static_cast<blt::size_t>(size) * size);
+                nodes = 0;
+                node_limit = new_node_limit;
+                if (problem.has_domains())
+                {
+                    for (blt::i32 position = 0; position < size; position++)
+                    {
+                        const auto index = static_cast<blt::size_t>(row) * size + position;
+                        for (blt::i32 choice = 0; choice < problem.domain_size(index); choice++)
+                            allowed[position * (size + 1) + problem.domain_value(index, choice)] = true;
+                    }
+                }
+                for (blt::i32 depth = 0; depth < size; depth++)
+                    std::iota(order.begin() + depth * size, order.begin() + (depth + 1) * size, cell_t{1});
+            }
+
+            [[nodiscard]] bool right_visible() const
+            {
+                if (right <= 0)
+                    return true;
+                blt::i32 seen = 0, highest = 0;
+                for (blt::i32 i = size - 1; i >= 0; i--)
+                {
+                    if (current[i] > highest)
+                    {
+                        ++seen;
+                        highest = current[i];
+                    }
+                }
+                return seen == right;
+            }
+
+            // calls found(current) for every candidate until it returns false. returns false when stopped by found or the node limit
+            template <typename Found>
+            bool search(const blt::i32 depth, const blt::i32 highest, const blt::i32 seen, Found& found)
+            {
+                if (depth == size)
+                    return !right_visible() || found(current);
+                if (++nodes > node_limit)
+                    return false;
+                for (blt::i32 i = 0; i < size; i++)
+                {
+                    const auto value = order[depth * size + i];
+                    if (used[value] || !allowed[depth * (size + 1) + value])
+                        continue;
+                    const auto next_seen = seen + (value > highest ? 1 : 0);
+                    const auto next_highest = std::max<blt::i32>(highest, value);
+                    if (left > 0)
+                    {
+                        // every unused value taller than the current maximum could at best add one more building
+                        const auto reachable = next_seen + (size - next_highest);
+                        if (next_seen > left || reachable < left)
+                            continue;
+                    }
+                    // from the right, at most one building per cell after the tallest is visible, plus the tallest itself
+                    if (right > 0 && value == size && size - depth < right)
+                        continue;
+                    used[value] = true;
+                    current[depth] = value;
+                    const bool keep_going = search(depth + 1, next_highest, next_seen, found);
+                    used[value] = false;
+                    if (!keep_going)
+                        return false;
+                }
+                return true;
+            }
+        };
+    }
+
+    void row_tables_t::build(const problem_t& problem, const blt::size_t max_row_entries)
+    {
+        board_size = problem.board_size;
+        this->max_row_entries = max_row_entries;
+        entries.clear();
+        offsets.assign(1, 0);
+        complete.assign(board_size, false);
+
+        // the number of candidates grows factorially, past this size rows are not worth trying to enumerate
+        if (board_size > max_enumerated_board_size)
+        {
+            offsets.resize(board_size + 1, 0);
+            return;
+        }
+
+        for (blt::i32 row = 0; row < board_size; row++)
+        {
+            const auto begin = entries.size();
+            // enough nodes to reach every stored entry a few times over, anything beyond that is left to sampling
+            row_search_t search{problem, row, static_cast<blt::u64>(max_row_entries) * 8};
+            blt::size_t count = 0;
+            auto store = [&](const std::vector<cell_t>& cells)
+            {
+                if (++count > max_row_entries)
+                    return false;
+                entries.insert(entries.end(), cells.begin(), cells.end());
+                return true;
+            };
+            complete[row] = search.search(0, 0, 0, store);
+            if (!complete[row])
+                entries.resize(begin);
+            else if (count == 0)
+                BLT_WARN("Row %d has no permutation agreeing with its clues", row);
+            offsets.push_back(entries.size() / board_size);
+        }
+    }
+
+    blt::size_t row_tables_t::find(const blt::i32 row, const cell_t* cells) const
+    {
+        // the search places smaller values first, so each table comes out in lexicographic order
+        blt::size_t low = 0, high = size(row);
+        while (low < high)
+        {
+            const auto middle = low + (high - low) / 2;
+            if (std::memcmp(entry(row, middle), cells, board_size) < 0)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        if (low < size(row) && std::memcmp(entry(row, low), cells, board_size) == 0)
+            return low;
+        return size(row);
+    }
+
+    void row_tables_t::sample(const problem_t& problem, const blt::i32 row, blt::random::random_t& random, cell_t* cells) const
+    {
+        if (complete[row] && size(row) > 0)
+        {
+            std::memcpy(cells, entry(row, random.get_size_t(0, size(row))), board_size);
+            return;
+        }
+
+        thread_local std::vector<cell_t> shuffled;
+        thread_local row_search_t search;
+        if (!complete[row])
+        {
+            // a bad early choice can leave a search stuck in a barren subtree, so each attempt gets a small budget and a fresh order
+            search.reset(problem, row, static_cast<blt::u64>(board_size) * board_size * 4);
+            bool found = false;
+            auto take = [&](const std::vector<cell_t>& candidate)
+            {
+                std::memcpy(cells, candidate.data(), board_size);
+                found = true;
+                return false;
+            };
+            for (blt::i32 attempt = 0; attempt < 32 && !found; attempt++)
+            {
+                for (blt::i32 depth = 0; depth < board_size; depth++)
+                    std::shuffle(search.order.begin() + depth * board_size, search.order.begin() + (depth + 1) * board_size, random);
+                search.nodes = 0;
+                search.search(0, 0, 0, take);
+            }
+            if (found)
+                return;
+        }
+        shuffled.resize(board_size);
+        std::iota(shuffled.begin(), shuffled.end(), cell_t{1});
+        std::shuffle(shuffled.begin(), shuffled.end(), random);
+        std::memcpy(cells, shuffled.data(), board_size);
+    }
+}
@@ -0,0 +1,131 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <run_controller.h>
+#include <algorithm>
+#include <chrono>
+
+namespace sky
+{
+    run_report_t run_controller_t::run(genetic_algorithm& ga, const blt::i32 elites, const blt::i32 k)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const auto elapsed = [start]()
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        };
+
+        const auto window = static_cast<blt::size_t>(std::max(config.window, 2));
+        best_history.assign(window, 0);
+        average_history.assign(window, 0);
+        history_size = 0;
+        history_head = 0;
+
+        const auto base_crossover = ga.get_crossover_rate();
+        const auto base_mutation = ga.get_mutation_rate();
+        const auto total_rate = base_crossover + base_mutation;
+        const auto base_share = base_mutation / total_rate;
+        auto mutation_share = base_share;
+
+        run_report_t report;
+        report.best_fitness = ga.best_fitness();
+        while (true)
+        {
+            if (config.stop_on_solution && report.best_fitness == 0)
+            {
+                report.reason = stop_reason_t::SOLVED;
+                break;
+            }
+            if (report.generations >= config.max_generations)
+            {
+                report.reason = stop_reason_t::GENERATION_LIMIT;
+                break;
+            }
+            if (config.time_limit_seconds > 0 && elapsed() >= config.time_limit_seconds)
+            {
+                report.reason = stop_reason_t::TIME_LIMIT;
+                break;
+            }
+            if (stop_predicate && stop_predicate())
+            {
+                report.reason = stop_reason_t::INTERRUPTED;
+                break;
+            }
+
+            ga.run_step(elites, k);
+            ++report.generations;
+
+            const generation_stats_t stats{report.generations, ga.best_fitness(), ga.average_fitness(), ga.get_last_diversity()};
+            if (generation_callback)
+                generation_callback(stats);
+
+            const bool improved = stats.best_fitness < report.best_fitness;
+            report.best_fitness = std::min(report.best_fitness, stats.best_fitness);
+
+            if (config.policy == restart_policy_t::ADAPT_RATES && improved && mutation_share > base_share)
+            {
+                mutation_share = std::max(base_share, mutation_share / config.mutation_growth);
+                ga.set_rates(total_rate * (1 - mutation_share), total_rate * mutation_share);
+            }
+
+            if (stagnated(stats))
+            {
+                ++report.stagnations;
+                switch (config.policy)
+                {
+                case restart_policy_t::NONE:
+                    break;
+                case restart_policy_t::ADAPT_RATES:
+                    mutation_share = std::min(config.max_mutation_share, mutation_share * config.mutation_growth);
+                    ga.set_rates(total_rate * (1 - mutation_share), total_rate * mutation_share);
+                    break;
+                case restart_policy_t::PARTIAL_RESTART:
+                    if (config.max_restarts <= 0 || report.restarts < config.max_restarts)
+                    {
+                        ga.reseed(config.restart_fraction, elites);
+                        ++report.restarts;
+                    }
+                    break;
+                }
+                // give the reaction a full window before judging again
+                history_size = 0;
+            }
+
+            best_history[history_head] = stats.best_fitness;
+            average_history[history_head] = stats.average_fitness;
+            history_head = (history_head + 1) % window;
+            history_size = std::min(history_size + 1, window);
+        }
+
+        ga.set_rates(base_crossover, base_mutation);
+        report.seconds = elapsed();
+        return report;
+    }
+
+    bool run_controller_t::stagnated(const generation_stats_t& stats) const
+    {
+        if (history_size < best_history.size())
+            return false;
+        // with a full ring the head holds the oldest entry
+        const auto oldest_best = best_history[history_head];
+        const auto oldest_average = average_history[history_head];
+        if (stats.best_fitness < oldest_best)
+            return false;
+        const bool average_stalled = oldest_average - stats.average_fitness < config.min_average_improvement * oldest_average;
+        return average_stalled || stats.diversity < config.min_diversity;
+    }
+}
@@ -0,0 +1,142 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <selection.h>
+#include <rng.h>
+#include <blt/std/utility.h>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace sky
+{
+    void selector_t::prepare(const population_t& population, blt::random::random_t& random)
+    {
+        const auto& fitness = population.fitness_values();
+        const auto size = fitness.size();
+
+        switch (strategy)
+        {
+        case selection_t::TOURNAMENT:
+            return;
+        case selection_t::RANK:
+            {
+                ranked.resize(size);
+                std::iota(ranked.begin(), ranked.end(), 0);
+                std::sort(ranked.begin(), ranked.end(), [&fitness](const auto a, const auto b)
+                {
+                    return fitness[a] < fitness[b];
+                });
+
+                cumulative.resize(size);
+                double total = 0;
+                for (blt::size_t rank = 0; rank < size; rank++)
+                {
+                    // linear ranking, weights fall from pressure at the best to 2 - pressure at the worst
+                    const double position = size > 1 ? static_cast<double>(rank) / static_cast<double>(size - 1) : 0.0;
+                    total += pressure - (2.0 * pressure - 2.0) * position;
+                    cumulative[rank] = total;
+                }
+                for (auto& value : cumulative)
+                    value /= total;
+            }
+            return;
+        case selection_t::STOCHASTIC_UNIVERSAL:
+            {
+                cumulative.resize(size);
+                double total = 0;
+                for (blt::size_t i = 0; i < size; i++)
+                {
+                    total += 1.0 / (1.0 + fitness[i]);
+                    cumulative[i] = total;
+                }
+
+                // every child takes at most two parents, plus some slack for re-picks of an identical second parent
+                const auto count = size * 2 + 16;
+                picks.resize(count);
+                const double spacing = total / static_cast<double>(count);
+                double pointer = spacing * (static_cast<double>(random.get_u64(0, std::numeric_limits<blt::u32>::max())) /
+                    static_cast<double>(std::numeric_limits<blt::u32>::max()));
+                blt::size_t index = 0;
+                for (auto& pick : picks)
+                {
+                    while (index + 1 < size && cumulative[index] < pointer)
+                        ++index;
+                    pick = index;
+                    pointer += spacing;
+                }
+                // the pointers are handed out in order, so break up the runs of identical parents
+                std::shuffle(picks.begin(), picks.end(), random);
+            }
+            return;
+        }
+    }
+
+    blt::size_t selector_t::select(const population_t& population, const blt::i32 k, blt::random::random_t& random, const blt::size_t draw) const
+    {
+        switch (strategy)
+        {
+        case selection_t::TOURNAMENT:
+            return tournament(population, k, random);
+        case selection_t::RANK:
+            {
+                const double point = static_cast<double>(random.get_u64(0, std::numeric_limits<blt::u32>::max())) /
+                    static_cast<double>(std::numeric_limits<blt::u32>::max());
+                const auto it = std::lower_bound(cumulative.begin(), cumulative.end(), point);
+                const auto rank = std::min(static_cast<blt::size_t>(it - cumulative.begin()), ranked.size() - 1);
+                return ranked[rank];
+            }
+        case selection_t::STOCHASTIC_UNIVERSAL:
+            return picks[draw % picks.size()];
+        }
+        BLT_UNREACHABLE;
+    }
+
+    blt::size_t selector_t::tournament(const population_t& population, const blt::i32 k, blt::random::random_t& random) const
+    {
+        // k distinct individuals by floyd's algorithm, which keeps no state between calls so the picks only depend on the stream.
+        // the random values for every round are drawn in one batch
+        const auto size = population.size();
+        const auto rounds = std::min(static_cast<blt::size_t>(std::max(k, 1)), size);
+
+        constexpr blt::size_t max_batch = 32;
+        blt::u64 draws[max_batch];
+        blt::size_t chosen[max_batch];
+        const auto key = random.get_u64(0, std::numeric_limits<blt::u64>::max());
+
+        blt::size_t index = 0;
+        blt::i32 best_fitness = std::numeric_limits<blt::i32>::max();
+        blt::size_t chosen_count = 0;
+        for (blt::size_t round = 0; round < rounds; ++round)
+        {
+            if (round % max_batch == 0)
+                rng::fill(key, round, draws, std::min(max_batch, rounds - round));
+            const auto limit = size - rounds + round;
+            auto point = static_cast<blt::size_t>(rng::bounded(draws[round % max_batch], static_cast<blt::u32>(limit + 1)));
+            // only the most recent picks are remembered for very large tournaments, which can let a repeat through
+            if (std::find(chosen, chosen + std::min(chosen_count, max_batch), point) != chosen + std::min(chosen_count, max_batch))
+                point = limit;
+            chosen[chosen_count++ % max_batch] = point;
+            if (population.fitness(point) < best_fitness)
+            {
+                index = point;
+                best_fitness = population.fitness(point);
+            }
+        }
+        return index;
+    }
+}
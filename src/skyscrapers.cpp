@@ -16,11 +16,20 @@
  *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #include <skyscrapers.h>
+#include <fitness_kernel.h>
+#include <rng.h>
 
 #include <blt/fs/loader.h>
 #include <blt/std/hashmap.h>
 #include <blt/std/logging.h>
 #include <blt/std/random.h>
+#include <blt/std/string.h>
+#include <bitset>
+#include <cctype>
+#include <charconv>
+#include <fstream>
+#include <iterator>
+#include <limits>
 
 namespace sky
 {
@@ -44,187 +53,427 @@ namespace sky
         BLT_TRACE_STREAM << "\n";
     }
 
-    blt::expected<problem_t, problem_t::error_t> problem_from_file(const std::string_view path)
+    namespace
     {
-        const auto lines = blt::fs::getLinesFromFile(path);
-
-        const auto size_line = blt::string::split(lines.front(), '\t');
-
-        if (size_line.size() != 2)
+        // the whole token as a number, surrounding whitespace allowed. unlike std::stoi nothing throws and trailing junk is an error
+        bool parse_number(std::string_view token, blt::i32& value)
         {
-            BLT_WARN("File is incorrectly formatted. First line is expected to describe board size like 'BOARD_SIZE:	#`");
-            return blt::unexpected(problem_t::error_t::MISSING_BOARD_SIZE);
+            while (!token.empty() && std::isspace(static_cast<unsigned char>(token.front())))
+                token.remove_prefix(1);
+            while (!token.empty() && std::isspace(static_cast<unsigned char>(token.back())))
+                token.remove_suffix(1);
+            const auto* end = token.data() + token.size();
+            const auto [last, error] = std::from_chars(token.data(), end, value);
+            return !token.empty() && error == std::errc{} && last == end;
         }
 
-        problem_t problem{std::stoi(size_line[1])};
-
-        if (lines.size() != static_cast<blt::size_t>(problem.board_size) + 3)
+        bool parse_clues(const std::vector<std::string>& tokens, std::vector<blt::i32>& clues)
         {
-            BLT_TRACE(lines.size());
-            BLT_TRACE(problem.board_size + 1);
-            BLT_WARN("File is incorrectly formatted. Expected problem to be defined as a series of lines, describing the structure of the board");
-            return blt::unexpected(problem_t::error_t::MISSING_BOARD_DATA);
+            for (const auto& token : tokens)
+            {
+                blt::i32 clue;
+                if (!parse_number(token, clue))
+                {
+                    BLT_WARN("File is incorrectly formatted. Clue '%s' is not a number", token.c_str());
+                    return false;
+                }
+                clues.push_back(clue);
+            }
+            return true;
         }
 
-        blt::size_t index = 1;
+        blt::expected<problem_t, problem_t::error_t> problem_from_lines(const std::vector<std::string>& lines)
+        {
+            const auto size_line = lines.empty() ? std::vector<std::string>{} : blt::string::split(lines.front(), '\t');
 
-        auto top_problems = blt::string::split(lines[index++], '\t');
+            if (size_line.size() != 2)
+            {
+                BLT_WARN("File is incorrectly formatted. First line is expected to describe board size like 'BOARD_SIZE:	#`");
+                return blt::unexpected(problem_t::error_t::MISSING_BOARD_SIZE);
+            }
 
-        if (top_problems.size() != static_cast<blt::size_t>(problem.board_size))
-        {
-            BLT_WARN("File is incorrectly formatted. Expected BOARD_SIZE '%d' number of elements got %lu", problem.board_size, top_problems.size());
-            return blt::unexpected(problem_t::error_t::INCORRECT_BOARD_DATA_FOR_SIZE);
-        }
+            blt::i32 board_size;
+            if (!parse_number(size_line[1], board_size) || board_size <= 0)
+            {
+                BLT_WARN("File is incorrectly formatted. Board size '%s' is not a positive number", size_line[1].c_str());
+                return blt::unexpected(problem_t::error_t::INCORRECT_BOARD_DATA_FOR_SIZE);
+            }
+            if (board_size > max_board_size)
+            {
+                BLT_WARN("Board size %d is larger than the maximum supported size of %d", board_size, max_board_size);
+                return blt::unexpected(problem_t::error_t::BOARD_TOO_LARGE);
+            }
 
-        for (const auto& arrow : top_problems)
-            problem.top.push_back(std::stoi(arrow));
+            problem_t problem{board_size};
 
-        for (blt::size_t i = 0; i < static_cast<blt::size_t>(problem.board_size); i++)
-        {
-            if (index >= lines.size())
+            const auto clue_lines = static_cast<blt::size_t>(problem.board_size) + 3;
+            // an optional reference solution follows the clues
+            const bool has_solution = lines.size() == clue_lines + 1 + problem.board_size && blt::string::starts_with(lines[clue_lines], "SOLUTION");
+            if (lines.size() != clue_lines && !has_solution)
             {
-                BLT_WARN("File is incorrectly formatted. Expected BOARD_SIZE '%d' number of rows describing the sizes of the board but got %lu",
-                         problem.board_size, lines.size());
+                BLT_TRACE(lines.size());
+                BLT_TRACE(problem.board_size + 1);
+                BLT_WARN("File is incorrectly formatted. Expected problem to be defined as a series of lines, describing the structure of the board");
+                return blt::unexpected(problem_t::error_t::MISSING_BOARD_DATA);
+            }
+
+            blt::size_t index = 1;
+
+            auto top_problems = blt::string::split(lines[index++], '\t');
+
+            if (top_problems.size() != static_cast<blt::size_t>(problem.board_size))
+            {
+                BLT_WARN("File is incorrectly formatted. Expected BOARD_SIZE '%d' number of elements got %lu", problem.board_size, top_problems.size());
+                return blt::unexpected(problem_t::error_t::INCORRECT_BOARD_DATA_FOR_SIZE);
+            }
+
+            if (!parse_clues(top_problems, problem.top))
                 return blt::unexpected(problem_t::error_t::INCORRECT_BOARD_DATA_FOR_SIZE);
+
+            for (blt::size_t i = 0; i < static_cast<blt::size_t>(problem.board_size); i++)
+            {
+                if (index >= lines.size())
+                {
+                    BLT_WARN("File is incorrectly formatted. Expected BOARD_SIZE '%d' number of rows describing the sizes of the board but got %lu",
+                             problem.board_size, lines.size());
+                    return blt::unexpected(problem_t::error_t::INCORRECT_BOARD_DATA_FOR_SIZE);
+                }
+                auto data = blt::string::split(lines[index++], '\t');
+                if (data.size() != 2)
+                {
+                    BLT_WARN("File is incorrectly formatted. Expected 2 points for the side data descriptors, got %lu", data.size());
+                    return blt::unexpected(problem_t::error_t::INCORRECT_BOARD_DATA_FOR_SIZE);
+                }
+                blt::i32 left, right;
+                if (!parse_number(data[0], left) || !parse_number(data[1], right))
+                {
+                    BLT_WARN("File is incorrectly formatted. Side clues '%s' and '%s' are not both numbers", data[0].c_str(), data[1].c_str());
+                    return blt::unexpected(problem_t::error_t::INCORRECT_BOARD_DATA_FOR_SIZE);
+                }
+                problem.left.push_back(left);
+                problem.right.push_back(right);
             }
-            auto data = blt::string::split(lines[index++], '\t');
-            if (data.size() != 2)
+
+            auto bottom_problems = blt::string::split(lines[index], '\t');
+
+            if (bottom_problems.size() != static_cast<blt::size_t>(problem.board_size))
             {
-                BLT_WARN("File is incorrectly formatted. Expected 2 points for the side data descriptors, got %lu", data.size());
+                BLT_WARN("File is incorrectly formatted. Expected BOARD_SIZE '%d' number of elements got %lu", problem.board_size, top_problems.size());
                 return blt::unexpected(problem_t::error_t::INCORRECT_BOARD_DATA_FOR_SIZE);
             }
-            problem.left.push_back(std::stoi(data[0]));
-            problem.right.push_back(std::stoi(data[1]));
-        }
 
-        auto bottom_problems = blt::string::split(lines[index], '\t');
+            if (!parse_clues(bottom_problems, problem.bottom))
+                return blt::unexpected(problem_t::error_t::INCORRECT_BOARD_DATA_FOR_SIZE);
 
-        if (bottom_problems.size() != static_cast<blt::size_t>(problem.board_size))
-        {
-            BLT_WARN("File is incorrectly formatted. Expected BOARD_SIZE '%d' number of elements got %lu", problem.board_size, top_problems.size());
-            return blt::unexpected(problem_t::error_t::INCORRECT_BOARD_DATA_FOR_SIZE);
+            return problem;
         }
 
-        for (const auto& arrow : bottom_problems)
-            problem.bottom.push_back(std::stoi(arrow));
+        // the lines after the clues, only called when the file has them
+        blt::expected<solution_t, problem_t::error_t> solution_from_lines(const std::vector<std::string>& lines, const blt::i32 size)
+        {
+            const auto clue_lines = static_cast<blt::size_t>(size) + 3;
+            solution_t solution{size};
+            for (blt::i32 row = 0; row < size; row++)
+            {
+                const auto data = blt::string::split(lines[clue_lines + 1 + row], '\t');
+                if (data.size() != static_cast<blt::size_t>(size))
+                {
+                    BLT_WARN("File is incorrectly formatted. Expected BOARD_SIZE '%d' number of cells in solution row %d got %lu", size, row,
+                             data.size());
+                    return blt::unexpected(problem_t::error_t::INCORRECT_BOARD_DATA_FOR_SIZE);
+                }
+                for (blt::i32 column = 0; column < size; column++)
+                {
+                    blt::i32 value;
+                    if (!parse_number(data[column], value) || value < 1 || value > size)
+                    {
+                        BLT_WARN("File is incorrectly formatted. Solution cell '%s' is not a value between 1 and %d", data[column].c_str(), size);
+                        return blt::unexpected(problem_t::error_t::INCORRECT_BOARD_DATA_FOR_SIZE);
+                    }
+                    solution.set(row, column, value);
+                }
+            }
+
+            return solution;
+        }
+    }
 
-        return problem;
+    blt::expected<problem_t, problem_t::error_t> problem_from_file(const std::string_view path)
+    {
+        return problem_from_lines(blt::fs::getLinesFromFile(path));
     }
 
-    void solution_t::init(const problem_t& problem)
+    blt::expected<solution_t, problem_t::error_t> solution_from_file(const std::string_view path)
     {
-        blt::random::random_t random{std::random_device{}()};
-        for (auto& v : board_data)
-            v = random.get_i32(problem.min(), problem.max() + 1);
+        const auto lines = blt::fs::getLinesFromFile(path);
+        auto problem = problem_from_lines(lines);
+        if (!problem)
+            return blt::unexpected(problem.error());
+        if (lines.size() <= static_cast<blt::size_t>(problem->board_size) + 3)
+        {
+            BLT_WARN("Problem file does not contain a reference solution");
+            return blt::unexpected(problem_t::error_t::MISSING_SOLUTION);
+        }
+        return solution_from_lines(lines, problem->board_size);
     }
 
-    blt::i32 solution_t::row_incorrect_count(const blt::i32 row) const
+    blt::expected<puzzle_file_t, problem_t::error_t> puzzle_from_file(const std::string_view path)
     {
-        thread_local std::vector<blt::i32> value_counts;
-        value_counts.resize(board_size);
-        std::memset(value_counts.data(), 0, sizeof(blt::i32) * board_size);
+        const auto lines = blt::fs::getLinesFromFile(path);
+        auto problem = problem_from_lines(lines);
+        if (!problem)
+            return blt::unexpected(problem.error());
+
+        puzzle_file_t puzzle{std::move(problem.value()), std::nullopt};
+        if (lines.size() > static_cast<blt::size_t>(puzzle.problem.board_size) + 3)
+        {
+            auto solution = solution_from_lines(lines, puzzle.problem.board_size);
+            if (!solution)
+                return blt::unexpected(solution.error());
+            puzzle.solution = std::move(solution.value());
+        }
+        return puzzle;
+    }
 
-        for (blt::i32 column = 0; column < board_size; column++)
-            ++value_counts[get(row, column) - 1];
+    bool problem_to_file(const std::string_view path, const problem_t& problem, const solution_t* solution)
+    {
+        std::ofstream file{std::string(path)};
+        if (!file)
+        {
+            BLT_WARN("Unable to open '%s' for writing", std::string(path).c_str());
+            return false;
+        }
 
-        blt::i32 sum = 0;
-        for (const auto v : value_counts)
-            sum += std::abs(v - 1);
+        file << "BOARD_SIZE:\t" << problem.board_size << "\n\n";
+        for (const auto clue : problem.top)
+            file << clue << '\t';
+        file << '\n';
+        for (blt::i32 i = 0; i < problem.board_size; i++)
+            file << problem.left[i] << '\t' << problem.right[i] << "\t\n";
+        for (const auto clue : problem.bottom)
+            file << clue << '\t';
+        file << '\n';
+
+        if (solution != nullptr)
+        {
+            file << "SOLUTION:\n";
+            for (blt::i32 row = 0; row < solution->board_size; row++)
+            {
+                for (blt::i32 column = 0; column < solution->board_size; column++)
+                    file << solution->get(row, column) << '\t';
+                file << '\n';
+            }
+        }
 
-        return sum;
+        return static_cast<bool>(file);
     }
 
-    blt::i32 solution_t::row_view_count(const problem_t& problem, const blt::i32 row) const
+    bool problem_t::propagate_domains()
     {
-        blt::i32 sees_left = 0;
-        blt::i32 sees_right = 0;
+        using domain_t = std::bitset<max_board_size + 1>;
+
+        const auto size = static_cast<blt::size_t>(board_size);
+        std::vector<domain_t> domains(size * size);
+        for (auto& domain : domains)
+        {
+            for (blt::i32 value = 1; value <= board_size; value++)
+                domain.set(value);
+        }
 
-        blt::i32 highest_left = 0;
-        blt::i32 highest_right = 0;
+        // cell at distance d from the clue, viewing along the line
+        const auto cell_of = [size](const blt::i32 side, const blt::size_t line, const blt::size_t d)
+        {
+            switch (side)
+            {
+            case 0:
+                return d * size + line;
+            case 1:
+                return (size - 1 - d) * size + line;
+            case 2:
+                return line * size + d;
+            default:
+                return line * size + (size - 1 - d);
+            }
+        };
+        const std::vector<blt::i32>* clues[4] = {&top, &bottom, &left, &right};
 
-        for (blt::i32 column = 0; column < board_size; column++)
+        for (blt::i32 side = 0; side < 4; side++)
         {
-            if (get(row, column) > highest_left)
+            for (blt::size_t line = 0; line < size; line++)
             {
-                ++sees_left;
-                highest_left = get(row, column);
+                const auto clue = (*clues[side])[line];
+                if (clue <= 0 || clue > board_size)
+                    continue;
+                if (clue == 1)
+                {
+                    auto& domain = domains[cell_of(side, line, 0)];
+                    const bool allowed = domain.test(board_size);
+                    domain.reset();
+                    domain.set(board_size, allowed);
+                }
+                // a building at distance d hides at least board_size - value buildings behind it, so it can't exceed board_size - clue + 1 + d
+                for (blt::size_t d = 0; d + 1 < static_cast<blt::size_t>(clue); d++)
+                {
+                    auto& domain = domains[cell_of(side, line, d)];
+                    for (auto value = board_size - clue + 2 + static_cast<blt::i32>(d); value <= board_size; value++)
+                        domain.reset(value);
+                }
             }
         }
 
-        for (blt::i32 column = board_size - 1; column >= 0; column--)
+        bool consistent = true;
+        bool changed = true;
+        while (changed && consistent)
         {
-            if (get(row, column) > highest_right)
+            changed = false;
+            // naked singles, a solved cell removes its value from every other cell in its row and column
+            for (blt::size_t index = 0; index < domains.size() && consistent; index++)
             {
-                ++sees_right;
-                highest_right = get(row, column);
+                if (domains[index].count() != 1)
+                    continue;
+                const auto row = index / size;
+                const auto column = index % size;
+                const auto value = domains[index];
+                for (blt::size_t i = 0; i < size; i++)
+                {
+                    for (const auto peer : {row * size + i, i * size + column})
+                    {
+                        if (peer == index || (domains[peer] & value).none())
+                            continue;
+                        domains[peer] &= ~value;
+                        changed = true;
+                        consistent &= domains[peer].any();
+                    }
+                }
+            }
+            // hidden singles, a value with only one possible place in a line must go there
+            for (blt::size_t line = 0; line < size && consistent; line++)
+            {
+                for (blt::size_t along_rows = 0; along_rows < 2; along_rows++)
+                {
+                    for (blt::i32 value = 1; value <= board_size; value++)
+                    {
+                        blt::size_t places = 0;
+                        blt::size_t place = 0;
+                        for (blt::size_t i = 0; i < size; i++)
+                        {
+                            const auto index = along_rows ? line * size + i : i * size + line;
+                            if (domains[index].test(value))
+                            {
+                                ++places;
+                                place = index;
+                            }
+                        }
+                        if (places == 0)
+                            consistent = false;
+                        else if (places == 1 && domains[place].count() > 1)
+                        {
+                            domains[place].reset();
+                            domains[place].set(value);
+                            changed = true;
+                        }
+                    }
+                }
             }
         }
 
-        const auto left = problem.left[row];
-        const auto right = problem.right[row];
+        domain_values.clear();
+        domain_offsets.clear();
+        fixed_cells.clear();
+        domain_offsets.push_back(0);
+        for (blt::size_t index = 0; index < domains.size(); index++)
+        {
+            for (blt::i32 value = 1; value <= board_size; value++)
+            {
+                if (!consistent || domains[index].test(value))
+                    domain_values.push_back(static_cast<cell_t>(value));
+            }
+            domain_offsets.push_back(static_cast<blt::u32>(domain_values.size()));
+            if (consistent && domains[index].count() == 1)
+                fixed_cells.push_back(static_cast<blt::u32>(index));
+        }
 
-        return std::abs(left - sees_left) + std::abs(right - sees_right);
+        if (!consistent)
+            BLT_WARN("Clues contradict each other, leaving every cell unconstrained");
+        return consistent;
     }
 
-    blt::i32 solution_t::column_view_count(const problem_t& problem, blt::i32 column) const
+    void solution_t::init(const problem_t& problem, blt::random::random_t& random)
     {
-        blt::i32 sees_top = 0;
-        blt::i32 sees_bottom = 0;
-
-        blt::i32 highest_top = 0;
-        blt::i32 highest_bottom = 0;
-
-        for (blt::i32 row = 0; row < board_size; row++)
+        // one draw keys a counter based stream, the cells are then filled in bulk from it
+        const auto key = random.get_u64(0, std::numeric_limits<blt::u64>::max());
+        if (!problem.has_domains())
         {
-            if (get(row, column) > highest_top)
-            {
-                ++sees_top;
-                highest_top = get(row, column);
-            }
+            rng::fill_cells(key, 0, board_data.data(), board_data.size(), problem.min(), problem.max());
+            return;
         }
-
-        for (blt::i32 row = board_size - 1; row >= 0; row--)
+        blt::u64 draws[64];
+        for (blt::size_t begin = 0; begin < board_data.size(); begin += std::size(draws))
         {
-            if (get(row, column) > highest_bottom)
+            const auto count = std::min(std::size(draws), board_data.size() - begin);
+            rng::fill(key, begin, draws, count);
+            for (blt::size_t i = 0; i < count; i++)
             {
-                ++sees_bottom;
-                highest_bottom = get(row, column);
+                const auto index = begin + i;
+                board_data[index] = problem.domain_value(index, static_cast<blt::i32>(rng::bounded(draws[i], problem.domain_size(index))));
             }
         }
+    }
 
-        const auto top = problem.top[column];
-        const auto bottom = problem.bottom[column];
+    blt::i32 solution_t::row_incorrect_count(const blt::i32 row) const
+    {
+        return kernel::reference_row_incorrect_count(board_data.data(), board_size, row);
+    }
+
+    blt::i32 solution_t::row_view_count(const problem_t& problem, const blt::i32 row) const
+    {
+        return kernel::reference_row_view_count(problem, board_data.data(), row);
+    }
 
-        return std::abs(top - sees_top) + std::abs(bottom - sees_bottom);
+    blt::i32 solution_t::column_view_count(const problem_t& problem, const blt::i32 column) const
+    {
+        return kernel::reference_column_view_count(problem, board_data.data(), column);
     }
 
     blt::i32 solution_t::column_incorrect_count(const blt::i32 column) const
     {
-        thread_local std::vector<blt::i32> value_counts;
-        value_counts.resize(board_size);
-        std::memset(value_counts.data(), 0, sizeof(blt::i32) * board_size);
+        return kernel::reference_column_incorrect_count(board_data.data(), board_size, column);
+    }
 
-        for (blt::i32 row = 0; row < board_size; row++)
-            ++value_counts[get(row, column) - 1];
+    blt::i32 solution_t::row_score(const problem_t& problem, const blt::i32 row, const fitness_kernel_t kernel) const
+    {
+        return score_row(problem, board_data.data(), row, kernel);
+    }
 
-        blt::i32 sum = 0;
-        for (const auto v : value_counts)
-            sum += std::abs(v - 1);
+    blt::i32 solution_t::column_score(const problem_t& problem, const blt::i32 column, const fitness_kernel_t kernel) const
+    {
+        return score_column(problem, board_data.data(), column, kernel);
+    }
 
-        return sum;
+    blt::i32 solution_t::fitness(const problem_t& problem, const fitness_kernel_t kernel) const
+    {
+        return score_lines(problem, board_data.data(), nullptr, kernel);
     }
 
     blt::i32 solution_t::fitness(const problem_t& problem) const
     {
-        blt::i32 fitness = 0;
-        for (blt::i32 i = 0; i < board_size; i++)
+        return score_lines(problem, board_data.data(), nullptr, fitness_kernel_t::REFERENCE);
+    }
+
+    void dirty_lines_t::mark_range(const blt::size_t begin, const blt::size_t end)
+    {
+        if (begin >= end)
+            return;
+        const auto size = static_cast<blt::size_t>(board_size);
+        for (auto row = begin / size; row <= (end - 1) / size; row++)
+            rows[row] = true;
+        if (end - begin >= size)
+            std::fill(columns.begin(), columns.end(), true);
+        else
         {
-            fitness += row_incorrect_count(i);
-            fitness += row_view_count(problem, i);
-            fitness += column_incorrect_count(i);
-            fitness += column_view_count(problem, i);
+            for (auto index = begin; index < end; index++)
+                columns[index % size] = true;
         }
-        return fitness;
     }
 
     void solution_t::print() const
@@ -0,0 +1,30 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <snapshot.h>
+
+namespace sky
+{
+    snapshot_buffer_t::snapshot_buffer_t(const blt::i32 board_size)
+    {
+        for (auto& buffer : buffers)
+        {
+            buffer.board_size = board_size;
+            buffer.best_board.resize(static_cast<blt::size_t>(board_size) * board_size);
+        }
+    }
+}
@@ -0,0 +1,164 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <solver.h>
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace sky
+{
+    backtracking_solver_t::backtracking_solver_t(problem_t problem): m_problem(std::move(problem))
+    {
+        if (m_problem.board_size > max_solver_board_size)
+            return;
+        if (!m_problem.has_domains())
+            m_problem.propagate_domains();
+
+        const auto size = static_cast<blt::size_t>(m_problem.board_size);
+        // bit v is value v, bit 0 is never used
+        domains.resize(size * size);
+        for (blt::size_t index = 0; index < domains.size(); index++)
+        {
+            for (blt::i32 choice = 0; choice < m_problem.domain_size(index); choice++)
+                domains[index] |= blt::u64{1} << m_problem.domain_value(index, choice);
+        }
+    }
+
+    blt::expected<solution_t, backtracking_solver_t::error_t> backtracking_solver_t::solve(const blt::u64 node_limit)
+    {
+        if (m_problem.board_size > max_solver_board_size)
+            return blt::unexpected(error_t::BOARD_TOO_LARGE);
+
+        const auto size = static_cast<blt::size_t>(m_problem.board_size);
+        board.assign(size * size, 0);
+        row_used.assign(size, 0);
+        column_used.assign(size, 0);
+        open_cells = static_cast<blt::i32>(size * size);
+        nodes_visited = 0;
+        this->node_limit = node_limit;
+        limit_reached = false;
+
+        if (!search())
+            return blt::unexpected(limit_reached ? error_t::NODE_LIMIT_REACHED : error_t::NO_SOLUTION);
+
+        solution_t solution{m_problem.board_size};
+        solution.board_data = board;
+        return solution;
+    }
+
+    blt::u64 backtracking_solver_t::candidates(const blt::size_t index) const
+    {
+        const auto size = static_cast<blt::size_t>(m_problem.board_size);
+        return domains[index] & ~row_used[index / size] & ~column_used[index % size];
+    }
+
+    bool backtracking_solver_t::search()
+    {
+        if (open_cells == 0)
+            return true;
+
+        // most constrained open cell first, an open cell with no candidates fails immediately
+        const auto size = static_cast<blt::size_t>(m_problem.board_size);
+        blt::size_t best = 0;
+        blt::i32 best_count = std::numeric_limits<blt::i32>::max();
+        for (blt::size_t index = 0; index < board.size(); index++)
+        {
+            if (board[index] != 0)
+                continue;
+            const auto count = __builtin_popcountll(candidates(index));
+            if (count < best_count)
+            {
+                best = index;
+                best_count = count;
+                if (count <= 1)
+                    break;
+            }
+        }
+        if (best_count == 0)
+            return false;
+
+        const auto row = best / size;
+        const auto column = best % size;
+        auto remaining = candidates(best);
+        while (remaining != 0)
+        {
+            if (node_limit != 0 && nodes_visited >= node_limit)
+            {
+                limit_reached = true;
+                return false;
+            }
+            ++nodes_visited;
+
+            const auto value = __builtin_ctzll(remaining);
+            const auto bit = blt::u64{1} << value;
+            remaining &= remaining - 1;
+
+            board[best] = static_cast<cell_t>(value);
+            row_used[row] |= bit;
+            column_used[column] |= bit;
+            --open_cells;
+
+            if (line_feasible(board.data() + row * size, 1, m_problem.left[row], m_problem.right[row]) &&
+                line_feasible(board.data() + column, static_cast<blt::i32>(size), m_problem.top[column], m_problem.bottom[column]) && search())
+                return true;
+
+            board[best] = 0;
+            row_used[row] &= ~bit;
+            column_used[column] &= ~bit;
+            ++open_cells;
+
+            if (limit_reached)
+                return false;
+        }
+        return false;
+    }
+
+    bool backtracking_solver_t::line_feasible(const cell_t* line, const blt::i32 stride, const blt::i32 first_clue, const blt::i32 last_clue) const
+    {
+        const auto size = m_problem.board_size;
+
+        // scans the assigned prefix seen from one end. buildings seen so far can only grow, and only by as many cells as remain behind
+        // the prefix or values remain taller than the tallest so far, whichever is smaller
+        const auto check = [line, stride, size](const blt::i32 clue, const blt::i32 start, const blt::i32 step)
+        {
+            if (clue <= 0)
+                return true;
+            blt::i32 seen = 0;
+            blt::i32 highest = 0;
+            blt::i32 prefix = 0;
+            for (blt::i32 i = start; prefix < size; prefix++, i += step)
+            {
+                const blt::i32 value = line[i * stride];
+                if (value == 0)
+                    break;
+                if (value > highest)
+                {
+                    ++seen;
+                    highest = value;
+                }
+            }
+            if (seen > clue)
+                return false;
+            if (highest == size)
+                return seen == clue;
+            return seen + std::min(size - highest, size - prefix) >= clue;
+        };
+
+        return check(first_clue, 0, 1) && check(last_clue, size - 1, -1);
+    }
+}
@@ -0,0 +1,112 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <telemetry.h>
+#include <blt/std/logging.h>
+#include <string>
+
+namespace sky
+{
+    namespace
+    {
+        constexpr char binary_magic[4] = {'S', 'K', 'Y', 'T'};
+        constexpr blt::u32 binary_version = 1;
+    }
+
+    telemetry_ring_t::telemetry_ring_t(const blt::size_t capacity)
+    {
+        blt::size_t size = 1;
+        while (size < capacity)
+            size <<= 1;
+        records.resize(size);
+        mask = size - 1;
+    }
+
+    telemetry_sink_t::telemetry_sink_t(telemetry_ring_t& ring, const std::string_view path, const telemetry_format_t format,
+                                       const std::chrono::milliseconds interval): ring(ring), format(format), interval(interval)
+    {
+        const auto mode = format == telemetry_format_t::BINARY ? std::ios::out | std::ios::binary : std::ios::out;
+        file.open(std::string(path), mode);
+        if (!file)
+        {
+            BLT_WARN("Unable to open telemetry file '%s'", std::string(path).c_str());
+            return;
+        }
+
+        if (format == telemetry_format_t::BINARY)
+        {
+            constexpr blt::u32 record_size = sizeof(generation_record_t);
+            file.write(binary_magic, sizeof(binary_magic));
+            file.write(reinterpret_cast<const char*>(&binary_version), sizeof(binary_version));
+            file.write(reinterpret_cast<const char*>(&record_size), sizeof(record_size));
+        } else
+            file << "generation,best_fitness,average_fitness,diversity,evaluations,select_ns,crossover_ns,mutate_ns,evaluate_ns\n";
+
+        thread = std::thread([this]()
+        {
+            loop();
+        });
+    }
+
+    telemetry_sink_t::~telemetry_sink_t()
+    {
+        {
+            std::scoped_lock lock{mutex};
+            stopping = true;
+        }
+        wake.notify_one();
+        if (thread.joinable())
+            thread.join();
+        if (ring.get_dropped() > 0)
+            BLT_WARN("Telemetry dropped %lu generation records, the ring was full", static_cast<unsigned long>(ring.get_dropped()));
+    }
+
+    void telemetry_sink_t::drain()
+    {
+        generation_record_t record{};
+        while (ring.pop(record))
+        {
+            if (format == telemetry_format_t::BINARY)
+            {
+                file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+                continue;
+            }
+            file << record.generation << ',' << record.best_fitness << ',' << record.average_fitness << ',' << record.diversity << ',';
+            file << record.evaluations << ',' << record.select_ns << ',' << record.crossover_ns << ',' << record.mutate_ns << ',';
+            file << record.evaluate_ns << '\n';
+        }
+        file.flush();
+    }
+
+    void telemetry_sink_t::loop()
+    {
+        std::unique_lock lock{mutex};
+        while (!stopping)
+        {
+            wake.wait_for(lock, interval, [this]()
+            {
+                return stopping;
+            });
+            lock.unlock();
+            drain();
+            lock.lock();
+        }
+        // a sink destroyed before the thread got here never ran the loop, and records may have arrived since the last pass
+        lock.unlock();
+        drain();
+    }
+}
@@ -0,0 +1,218 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <genetic_algorithm.h>
+#include <run_controller.h>
+#include <snapshot.h>
+#include <blt/gfx/window.h>
+#include "blt/gfx/renderer/resource_manager.h"
+#include "blt/gfx/renderer/batch_2d_renderer.h"
+#include "blt/gfx/renderer/camera.h"
+#include <blt/parse/argparse.h>
+#include <blt/std/logging.h>
+#include <skyscrapers.h>
+#include <imgui.h>
+#include <atomic>
+#include <cfloat>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+
+// the solver runs on its own thread and only ever talks to the window through the snapshot buffer, so a slow frame never stalls a
+// generation and a slow generation never stalls a frame
+
+blt::gfx::matrix_state_manager global_matrices;
+blt::gfx::resource_manager resources;
+blt::gfx::batch_renderer_2d renderer_2d(resources, global_matrices);
+blt::gfx::first_person_camera camera;
+
+std::unique_ptr<sky::problem_t> problem;
+std::unique_ptr<sky::snapshot_buffer_t> snapshots;
+std::thread solver_thread;
+std::atomic_bool stop_requested = false;
+
+// fitness curves, only touched by the render thread
+std::vector<float> best_history;
+std::vector<float> average_history;
+std::vector<float> diversity_history;
+constexpr blt::size_t max_history = 2048;
+
+void push_history(std::vector<float>& history, const float value)
+{
+    if (history.size() == max_history)
+        history.erase(history.begin());
+    history.push_back(value);
+}
+
+void draw_board(const sky::run_snapshot_t& snapshot)
+{
+    const auto size = snapshot.board_size;
+    // one extra row / column on each side for the clues
+    const float cell = std::max(16.0f, std::min(48.0f, 480.0f / static_cast<float>(size + 2)));
+    auto* draw_list = ImGui::GetWindowDrawList();
+    const auto origin = ImGui::GetCursorScreenPos();
+
+    const auto draw_text = [&](const blt::i32 row, const blt::i32 column, const blt::i32 value, const ImU32 color)
+    {
+        if (value <= 0)
+            return;
+        const auto text = std::to_string(value);
+        const auto text_size = ImGui::CalcTextSize(text.c_str());
+        const ImVec2 position{origin.x + (static_cast<float>(column) + 0.5f) * cell - text_size.x * 0.5f,
+                              origin.y + (static_cast<float>(row) + 0.5f) * cell - text_size.y * 0.5f};
+        draw_list->AddText(position, color, text.c_str());
+    };
+
+    constexpr ImU32 clue_color = IM_COL32(255, 200, 80, 255);
+    for (blt::i32 i = 0; i < size; i++)
+    {
+        draw_text(0, i + 1, problem->top[i], clue_color);
+        draw_text(size + 1, i + 1, problem->bottom[i], clue_color);
+        draw_text(i + 1, 0, problem->left[i], clue_color);
+        draw_text(i + 1, size + 1, problem->right[i], clue_color);
+    }
+
+    for (blt::i32 row = 0; row < size; row++)
+    {
+        for (blt::i32 column = 0; column < size; column++)
+        {
+            const ImVec2 min{origin.x + static_cast<float>(column + 1) * cell, origin.y + static_cast<float>(row + 1) * cell};
+            const ImVec2 max{min.x + cell - 1, min.y + cell - 1};
+            // taller buildings are drawn brighter
+            const auto value = snapshot.best_board[row * size + column];
+            const auto shade = static_cast<int>(40 + 160 * value / std::max(size, 1));
+            draw_list->AddRectFilled(min, max, IM_COL32(shade / 2, shade / 2, shade, 255));
+            draw_text(row + 1, column + 1, value, IM_COL32(255, 255, 255, 255));
+        }
+    }
+
+    ImGui::Dummy(ImVec2{cell * static_cast<float>(size + 2), cell * static_cast<float>(size + 2)});
+}
+
+void init(const blt::gfx::window_data&)
+{
+    using namespace blt::gfx;
+
+
+    global_matrices.create_internals();
+    resources.load_resources();
+    renderer_2d.create();
+}
+
+void update(const blt::gfx::window_data& data)
+{
+    global_matrices.update_perspectives(data.width, data.height, 90, 0.1, 2000);
+
+    camera.update();
+    camera.update_view(global_matrices);
+    global_matrices.update();
+
+    if (snapshots->acquire())
+    {
+        const auto& latest = snapshots->latest();
+        push_history(best_history, static_cast<float>(latest.best_fitness));
+        push_history(average_history, static_cast<float>(latest.average_fitness));
+        push_history(diversity_history, static_cast<float>(latest.diversity));
+    }
+    const auto& snapshot = snapshots->latest();
+
+    ImGui::SetNextWindowSize(ImVec2{560, 820}, ImGuiCond_Once);
+    if (ImGui::Begin("Skyscrapers"))
+    {
+        ImGui::Text("Generation %lu", static_cast<unsigned long>(snapshot.generation));
+        ImGui::Text("Best fitness %d, average %.2f, diversity %.3f", snapshot.best_fitness, snapshot.average_fitness, snapshot.diversity);
+        draw_board(snapshot);
+        if (!best_history.empty())
+        {
+            ImGui::PlotLines("Best", best_history.data(), static_cast<int>(best_history.size()), 0, nullptr, 0, FLT_MAX, ImVec2{0, 80});
+            ImGui::PlotLines("Average", average_history.data(), static_cast<int>(average_history.size()), 0, nullptr, 0, FLT_MAX,
+                             ImVec2{0, 80});
+            ImGui::PlotLines("Diversity", diversity_history.data(), static_cast<int>(diversity_history.size()), 0, nullptr, 0, 1,
+                             ImVec2{0, 80});
+        }
+    }
+    ImGui::End();
+
+    renderer_2d.render(data.width, data.height);
+}
+
+void destroy(const blt::gfx::window_data&)
+{
+    stop_requested = true;
+    if (solver_thread.joinable())
+        solver_thread.join();
+    global_matrices.cleanup();
+    resources.cleanup();
+    renderer_2d.cleanup();
+    blt::gfx::cleanup();
+}
+
+int main(int argc, const char** argv)
+{
+    blt::arg_parse parser;
+
+    parser.addArgument(blt::arg_builder("file").setHelp("Skyscraper file to solve while watching").build());
+    parser.addArgument(blt::arg_builder("--population").setDefault("500").build());
+    parser.addArgument(blt::arg_builder("--generations").setDefault("0").setHelp("Generation budget, 0 to run until solved or closed").build());
+    parser.addArgument(blt::arg_builder("--workers").setDefault("1").setHelp("Threads used to build each generation").build());
+
+    auto args = parser.parse_args(argc, argv);
+
+    if (!args.contains("file"))
+    {
+        BLT_WARN("Please provide a skyscraper formatted file!");
+        return EXIT_FAILURE;
+    }
+
+    auto parsed = sky::problem_from_file(args.get<std::string>("file"));
+    if (!parsed)
+    {
+        BLT_WARN("Unable to parse skyscraper file!");
+        return EXIT_FAILURE;
+    }
+    problem = std::make_unique<sky::problem_t>(std::move(parsed.value()));
+    snapshots = std::make_unique<sky::snapshot_buffer_t>(problem->board_size);
+
+    sky::run_controller_config_t control;
+    control.max_generations = std::stoi(args.get<std::string>("--generations"));
+    const auto population = std::stoi(args.get<std::string>("--population"));
+    const auto workers = std::stoul(args.get<std::string>("--workers"));
+
+    solver_thread = std::thread([control, population, workers]() mutable
+    {
+        sky::genetic_algorithm ga{*problem, population, 0.8, 0.1};
+        ga.set_worker_count(workers);
+        ga.set_snapshot_buffer(snapshots.get());
+        // without a budget the run only ends once solved or when the window closes
+        if (control.max_generations <= 0)
+            control.max_generations = std::numeric_limits<blt::i32>::max();
+        sky::run_controller_t controller{control};
+        controller.set_stop_predicate([]()
+        {
+            return stop_requested.load(std::memory_order_relaxed);
+        });
+        const auto report = controller.run(ga, 2, 5);
+        BLT_TRACE("Stopped after %d generations, best fitness %d", report.generations, ga.best_fitness());
+    });
+
+    blt::gfx::init(blt::gfx::window_data{"Skyscrapers GA", init, update, destroy}.setSyncInterval(1));
+
+    stop_requested = true;
+    if (solver_thread.joinable())
+        solver_thread.join();
+}
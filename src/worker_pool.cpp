@@ -0,0 +1,93 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <worker_pool.h>
+
+namespace sky
+{
+    worker_pool_t::worker_pool_t(const blt::size_t task_count)
+    {
+        for (blt::size_t task = 1; task < task_count; task++)
+            threads.emplace_back([this, task]()
+            {
+                worker_loop(task);
+            });
+    }
+
+    worker_pool_t::~worker_pool_t()
+    {
+        {
+            std::scoped_lock lock{mutex};
+            stopping = true;
+        }
+        start_condition.notify_all();
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    void worker_pool_t::dispatch(void (*job)(void*, blt::size_t), void* context)
+    {
+        {
+            std::scoped_lock lock{mutex};
+            this->job = job;
+            this->context = context;
+            running = threads.size();
+            ++generation;
+        }
+        start_condition.notify_all();
+
+        job(context, 0);
+
+        std::unique_lock lock{mutex};
+        done_condition.wait(lock, [this]()
+        {
+            return running == 0;
+        });
+    }
+
+    void worker_pool_t::worker_loop(const blt::size_t task)
+    {
+        blt::u64 seen_generation = 0;
+        while (true)
+        {
+            void (*current_job)(void*, blt::size_t);
+            void* current_context;
+            {
+                std::unique_lock lock{mutex};
+                start_condition.wait(lock, [this, seen_generation]()
+                {
+                    return stopping || generation != seen_generation;
+                });
+                if (stopping)
+                    return;
+                seen_generation = generation;
+                current_job = job;
+                current_context = context;
+            }
+
+            current_job(current_context, task);
+
+            bool last;
+            {
+                std::scoped_lock lock{mutex};
+                last = --running == 0;
+            }
+            if (last)
+                done_condition.notify_one();
+        }
+    }
+}
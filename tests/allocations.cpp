@@ -0,0 +1,92 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "test.h"
+#include <allocation_tracker.h>
+#include <functional>
+#include <generator.h>
+
+// only meaningful when built with TRACK_ALLOCATIONS, otherwise every count reads zero and the checks pass trivially
+namespace
+{
+    // once the buffers have grown to their final size a step must not touch the heap, whatever the configuration
+    void check_steps(const char* name, const sky::problem_t& problem, const std::function<void(sky::genetic_algorithm&)>& configure)
+    {
+        for (const blt::size_t workers : {1, 3})
+        {
+            sky::genetic_algorithm ga{problem, 200, 0.8, 0.1, 19};
+            configure(ga);
+            ga.set_worker_count(workers);
+            for (blt::i32 step = 0; step < 5; step++)
+                ga.run_step();
+            blt::u64 allocations = 0;
+            for (blt::i32 step = 0; step < 20; step++)
+            {
+                ga.run_step();
+                allocations += ga.get_last_step_allocations();
+            }
+            if (allocations != 0)
+                std::printf("%s with %zu workers made %llu allocations\n", name, static_cast<size_t>(workers),
+                            static_cast<unsigned long long>(allocations));
+            SKY_CHECK(allocations == 0);
+        }
+    }
+}
+
+int main()
+{
+    sky::puzzle_generator_t generator{6};
+    const auto puzzle = generator.generate(7);
+    const auto& problem = puzzle.problem;
+    if (!sky::allocations::enabled)
+        std::printf("allocation tracking is off, the counts are not checked\n");
+
+    check_steps("generational", problem, [](sky::genetic_algorithm&)
+    {
+    });
+    check_steps("duplicate removal", problem, [](sky::genetic_algorithm& ga)
+    {
+        ga.set_duplicate_policy(sky::duplicate_policy_t::REPLACE);
+    });
+    check_steps("batched evaluation", problem, [](sky::genetic_algorithm& ga)
+    {
+        ga.set_evaluation(sky::evaluation_t::BATCHED);
+        ga.set_fitness_cache(1 << 12);
+    });
+    check_steps("crowding", problem, [](sky::genetic_algorithm& ga)
+    {
+        ga.set_replacement({sky::replacement_t::DETERMINISTIC_CROWDING});
+    });
+    check_steps("sharing", problem, [](sky::genetic_algorithm& ga)
+    {
+        ga.set_replacement({sky::replacement_t::FITNESS_SHARING});
+    });
+    check_steps("local search", problem, [](sky::genetic_algorithm& ga)
+    {
+        ga.set_local_search({sky::local_search_t::TABU});
+    });
+    check_steps("row encoding", problem, [](sky::genetic_algorithm& ga)
+    {
+        ga.set_encoding(sky::encoding_t::ROW_PERMUTATION);
+    });
+    check_steps("steady state", problem, [](sky::genetic_algorithm& ga)
+    {
+        ga.set_steady_state({16, sky::steady_victim_t::TOURNAMENT_LOSER});
+        ga.set_duplicate_policy(sky::duplicate_policy_t::REMUTATE);
+    });
+    return sky::test::finish("allocations");
+}
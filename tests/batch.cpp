@@ -0,0 +1,157 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "test.h"
+#include <batch.h>
+#include <generator.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    void write_file(const fs::path& path, const std::string& contents)
+    {
+        std::ofstream out{path};
+        out << contents;
+    }
+
+    std::vector<std::string> lines_of(const std::string& text)
+    {
+        std::vector<std::string> lines;
+        std::istringstream in{text};
+        for (std::string line; std::getline(in, line);)
+            lines.push_back(line);
+        return lines;
+    }
+
+    bool contains(const std::string& line, const std::string& part)
+    {
+        return line.find(part) != std::string::npos;
+    }
+
+    // malformed files are reported as parse errors, they never throw
+    void test_parser(const fs::path& directory)
+    {
+        const std::pair<const char*, const char*> bad_files[] = {
+            {"letters", "BOARD_SIZE:\tx\n\n1\t2\n"},
+            {"zero", "BOARD_SIZE:\t0\n\n"},
+            {"negative", "BOARD_SIZE:\t-3\n\n"},
+            {"empty", ""},
+            {"clue", "BOARD_SIZE:\t2\n\n1\ta\n1\t2\n2\t1\n2\t1\n"},
+            {"side", "BOARD_SIZE:\t2\n\n1\t2\n1\t2x\n2\t1\n2\t1\n"},
+            {"huge", "BOARD_SIZE:\t99999999999999999999\n\n"},
+        };
+        for (const auto& [name, contents] : bad_files)
+        {
+            const auto path = (directory / name).string();
+            write_file(path, contents);
+            SKY_CHECK(!sky::problem_from_file(path).has_value());
+            SKY_CHECK(!sky::puzzle_from_file(path).has_value());
+        }
+
+        // surrounding whitespace is fine, a solution cell out of range is not
+        const auto spaced = (directory / "spaced").string();
+        write_file(spaced, "BOARD_SIZE:\t 2 \n\n 2\t1 \n2\t1\r\n1\t2\n1\t2\nSOLUTION:\n1\t2\n2\t1\n");
+        auto puzzle = sky::puzzle_from_file(spaced);
+        SKY_CHECK(puzzle.has_value() && puzzle->solution.has_value());
+        const auto bad_solution = (directory / "bad-solution").string();
+        write_file(bad_solution, "BOARD_SIZE:\t2\n\n2\t1\n2\t1\n1\t2\n1\t2\nSOLUTION:\n1\t2\n2\t7\n");
+        SKY_CHECK(!sky::puzzle_from_file(bad_solution).has_value());
+    }
+
+    sky::batch_config_t small_config(const blt::size_t workers)
+    {
+        sky::batch_config_t config;
+        config.workers = workers;
+        config.individual_count = 100;
+        config.seed = 3;
+        config.control.max_generations = 20;
+        return config;
+    }
+
+    // every file gets exactly one JSON line, bad ones an error, and the good ones are solved whatever else is in the directory
+    void test_directory(const fs::path& directory)
+    {
+        sky::puzzle_generator_t generator{21};
+        for (const auto size : {4, 5, 6})
+        {
+            const auto puzzle = generator.generate(size);
+            SKY_CHECK(sky::problem_to_file((directory / ("puzzle-" + std::to_string(size))).string(), puzzle.problem));
+        }
+        write_file(directory / "README", "these puzzles are for the batch test\n");
+        write_file(directory / "broken", "BOARD_SIZE:\tx\n");
+
+        const auto files = sky::collect_batch_files(directory.string());
+        for (const auto workers : {1, 3})
+        {
+            std::ostringstream out;
+            const auto solved = sky::run_batch(files, small_config(workers), out);
+            SKY_CHECK(solved == 3);
+            const auto lines = lines_of(out.str());
+            SKY_CHECK(lines.size() == files.size());
+            blt::size_t errors = 0;
+            for (const auto& line : lines)
+            {
+                SKY_CHECK(line.front() == '{' && line.back() == '}');
+                SKY_CHECK(contains(line, "\"file\":\"") && contains(line, "\"solved\":") && contains(line, "\"method\":"));
+                if (contains(line, "\"error\":"))
+                {
+                    ++errors;
+                    SKY_CHECK(contains(line, "\"solved\":false"));
+                }
+                else
+                {
+                    SKY_CHECK(contains(line, "puzzle-") && contains(line, "\"solved\":true") && contains(line, "\"solution\":[["));
+                }
+            }
+            SKY_CHECK(errors == files.size() - 3);
+        }
+    }
+
+    void test_json()
+    {
+        sky::batch_result_t result;
+        result.file = "odd \"name\"\\path";
+        result.error = "line\nbreak";
+        std::ostringstream out;
+        sky::write_batch_result(out, result);
+        const auto line = out.str();
+        SKY_CHECK(contains(line, "\"file\":\"odd \\\"name\\\"\\\\path\""));
+        SKY_CHECK(contains(line, "\"error\":\"line break\""));
+        SKY_CHECK(line.find('\n') == std::string::npos);
+    }
+}
+
+int main()
+{
+    const auto directory = fs::temp_directory_path() / "skyscrapers-ga-batch-test";
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+    fs::create_directories(directory / "parser");
+    fs::create_directories(directory / "batch");
+    test_parser(directory / "parser");
+    test_directory(directory / "batch");
+    test_json();
+    fs::remove_all(directory);
+    return sky::test::finish("batch");
+}
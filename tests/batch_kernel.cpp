@@ -0,0 +1,85 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "test.h"
+#include <fitness_kernel.h>
+#include <generator.h>
+#include <skyscrapers.h>
+#include <vector>
+
+namespace
+{
+    // boards of in range values, the precondition of every kernel but the reference one
+    std::vector<sky::solution_t> random_boards(const blt::i32 size, const blt::size_t count, blt::random::random_t& random)
+    {
+        std::vector<sky::solution_t> boards;
+        for (blt::size_t i = 0; i < count; i++)
+        {
+            boards.emplace_back(size);
+            for (auto& cell : boards.back().board_data)
+                cell = static_cast<sky::cell_t>(random.get_i32(1, size + 1));
+        }
+        return boards;
+    }
+
+    // batch sizes that are not a multiple of the lane count exercise the partial last batch
+    void test_batch_scores(const sky::problem_t& problem, const std::vector<sky::solution_t>& boards)
+    {
+        const auto lines = static_cast<blt::size_t>(problem.board_size) * 2;
+        std::vector<const sky::cell_t*> pointers;
+        std::vector<std::vector<blt::i32>> line_scores(boards.size(), std::vector<blt::i32>(lines));
+        std::vector<blt::i32*> line_pointers;
+        for (blt::size_t i = 0; i < boards.size(); i++)
+        {
+            pointers.push_back(boards[i].board_data.data());
+            line_pointers.push_back(line_scores[i].data());
+        }
+        std::vector<blt::i32> fitness(boards.size());
+        sky::kernel::batch_line_scores(problem, pointers.data(), pointers.size(), fitness.data(), line_pointers.data());
+
+        for (blt::size_t i = 0; i < boards.size(); i++)
+        {
+            std::vector<blt::i32> expected(lines);
+            SKY_CHECK(fitness[i] == boards[i].fitness(problem));
+            (void) sky::score_lines(problem, boards[i].board_data.data(), expected.data(), sky::fitness_kernel_t::REFERENCE);
+            SKY_CHECK(line_scores[i] == expected);
+        }
+    }
+}
+
+int main()
+{
+    blt::random::random_t random{43};
+    for (const auto size : {2, 3, 4, 5, 6, 7, 8, 9, 10, 12, 16, 33})
+    {
+        sky::puzzle_generator_t generator{static_cast<blt::u64>(size)};
+        auto puzzle = generator.generate(size);
+        // 46 boards leave a partial second batch
+        auto boards = random_boards(size, 45, random);
+        boards.push_back(puzzle.solution);
+        test_batch_scores(puzzle.problem, boards);
+
+        // clues outside 1..N (missing, negative, too tall) score the same as with the reference kernel
+        auto odd_clues = puzzle.problem;
+        odd_clues.top[0] = 0;
+        odd_clues.bottom[0] = -1;
+        odd_clues.left[size - 1] = size + 3;
+        odd_clues.right[size / 2] = 300;
+        test_batch_scores(odd_clues, boards);
+    }
+    return sky::test::finish("batch kernel");
+}
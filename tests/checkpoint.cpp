@@ -0,0 +1,134 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "test.h"
+#include <checkpoint.h>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <generator.h>
+#include <iterator>
+#include <utility>
+
+namespace
+{
+    constexpr const char* path = "skyscrapers-ga-test.ckpt";
+    constexpr const char* corrupt_path = "skyscrapers-ga-corrupt.ckpt";
+
+    std::vector<unsigned char> read_file(const char* file)
+    {
+        std::ifstream stream{file, std::ios::binary};
+        return {std::istreambuf_iterator<char>{stream}, std::istreambuf_iterator<char>{}};
+    }
+
+    void write_file(const char* file, const std::vector<unsigned char>& bytes)
+    {
+        std::ofstream stream{file, std::ios::binary | std::ios::trunc};
+        stream.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    void test_round_trip(const sky::problem_t& problem)
+    {
+        sky::genetic_algorithm original{problem, 150, 0.7, 0.2, 11};
+        original.set_steady_state({16, sky::steady_victim_t::TOURNAMENT_LOSER});
+        original.set_duplicate_policy(sky::duplicate_policy_t::REMUTATE);
+        for (blt::i32 generation = 0; generation < 10; generation++)
+            original.run_step();
+        SKY_CHECK(sky::save_checkpoint(path, original));
+
+        auto checkpoint = sky::checkpoint_t::open(path);
+        SKY_CHECK(checkpoint.has_value());
+        if (!checkpoint.has_value())
+            return;
+        const auto& header = checkpoint.value().header();
+        const auto& population = original.get_population();
+        const auto cells = static_cast<blt::size_t>(problem.board_size) * problem.board_size;
+        SKY_CHECK(header.generation == original.get_generation());
+        SKY_CHECK(header.individual_count == population.size());
+        SKY_CHECK(header.steady_births == 16);
+        const auto restored = checkpoint.value().problem();
+        SKY_CHECK(restored.top == problem.top && restored.bottom == problem.bottom);
+        SKY_CHECK(restored.left == problem.left && restored.right == problem.right);
+        for (blt::size_t i = 0; i < population.size(); i++)
+        {
+            SKY_CHECK(std::memcmp(checkpoint.value().cells(i), population.cells(i), cells) == 0);
+            SKY_CHECK(checkpoint.value().fitness(i) == population.fitness(i));
+        }
+
+        // a resumed run carries on exactly like the original one, whatever its worker count
+        sky::genetic_algorithm resumed{checkpoint.value()};
+        resumed.set_worker_count(2);
+        SKY_CHECK(resumed.get_duplicate_policy() == sky::duplicate_policy_t::REMUTATE);
+        SKY_CHECK(resumed.get_steady_state().victim == sky::steady_victim_t::TOURNAMENT_LOSER);
+        for (blt::i32 generation = 0; generation < 10; generation++)
+        {
+            original.run_step();
+            resumed.run_step();
+        }
+        SKY_CHECK(sky::test::digest(resumed) == sky::test::digest(original));
+    }
+
+    // writes a copy of the saved checkpoint with one header field overwritten and tries to open it
+    template <typename T>
+    bool opens_with(const std::size_t offset, const T value)
+    {
+        auto bytes = read_file(path);
+        std::memcpy(bytes.data() + offset, &value, sizeof(value));
+        write_file(corrupt_path, bytes);
+        return sky::checkpoint_t::open(corrupt_path).has_value();
+    }
+
+    void test_corrupt()
+    {
+        using header_t = sky::checkpoint_header_t;
+        // every enum field with its number of enumerators, the last one opens and the one past it is rejected
+        const std::pair<std::size_t, blt::u32> enums[] = {
+            {offsetof(header_t, kernel), 3}, {offsetof(header_t, selection), 3}, {offsetof(header_t, local_search_mode), 3},
+            {offsetof(header_t, duplicate_policy), 3}, {offsetof(header_t, encoding), 2}, {offsetof(header_t, replacement_mode), 3},
+            {offsetof(header_t, steady_victim), 2}, {offsetof(header_t, evaluation), 2}
+        };
+        for (const auto& [offset, count] : enums)
+        {
+            SKY_CHECK(opens_with(offset, count - 1));
+            SKY_CHECK(!opens_with(offset, count));
+            SKY_CHECK(!opens_with(offset, blt::u32{0xFFFFFFFF}));
+        }
+        SKY_CHECK(!opens_with(offsetof(header_t, magic), 'X'));
+        SKY_CHECK(!opens_with(offsetof(header_t, version), blt::u32{header_t::current_version - 1}));
+        SKY_CHECK(!opens_with(offsetof(header_t, board_size), blt::i32{0}));
+        SKY_CHECK(!opens_with(offsetof(header_t, board_size), blt::i32{-4}));
+        SKY_CHECK(!opens_with(offsetof(header_t, individual_count), blt::u64{1} << 40));
+
+        auto bytes = read_file(path);
+        bytes.resize(bytes.size() - 1);
+        write_file(corrupt_path, bytes);
+        SKY_CHECK(!sky::checkpoint_t::open(corrupt_path).has_value());
+        SKY_CHECK(!sky::checkpoint_t::open("skyscrapers-ga-missing.ckpt").has_value());
+        std::remove(corrupt_path);
+    }
+}
+
+int main()
+{
+    sky::puzzle_generator_t generator{5};
+    const auto puzzle = generator.generate(6);
+    test_round_trip(puzzle.problem);
+    test_corrupt();
+    std::remove(path);
+    return sky::test::finish("checkpoint");
+}
@@ -0,0 +1,172 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "test.h"
+#include <corpus.h>
+#include <generator.h>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    std::vector<char> read_bytes(const std::string& path)
+    {
+        std::ifstream in{path, std::ios::binary};
+        return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    }
+
+    void write_bytes(const std::string& path, const std::vector<char>& bytes)
+    {
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    bool same_clues(const sky::problem_t& a, const sky::problem_t& b)
+    {
+        return a.board_size == b.board_size && a.top == b.top && a.bottom == b.bottom && a.left == b.left && a.right == b.right;
+    }
+
+    // every puzzle comes back out of the mapping as it went in, solutions only where one was stored
+    void test_round_trip(const fs::path& directory)
+    {
+        sky::puzzle_generator_t generator{31};
+        std::vector<sky::generated_puzzle_t> puzzles;
+        std::vector<sky::problem_t> problems;
+        std::vector<const sky::solution_t*> solutions;
+        for (const auto size : {3, 5, 8, 12, 4})
+            puzzles.push_back(generator.generate(size));
+        for (blt::size_t i = 0; i < puzzles.size(); i++)
+        {
+            problems.push_back(puzzles[i].problem);
+            solutions.push_back(i % 2 == 0 ? &puzzles[i].solution : nullptr);
+        }
+
+        const auto path = (directory / "round-trip.corpus").string();
+        SKY_CHECK(sky::write_corpus(path, problems, solutions));
+        SKY_CHECK(sky::corpus_t::is_corpus(path));
+        auto corpus = sky::corpus_t::open(path);
+        SKY_CHECK(corpus.has_value());
+        if (!corpus.has_value())
+            return;
+        SKY_CHECK(corpus->size() == puzzles.size());
+        sky::problem_t reused{0};
+        for (blt::size_t i = 0; i < corpus->size(); i++)
+        {
+            const auto view = (*corpus)[i];
+            SKY_CHECK(same_clues(view.to_problem(), problems[i]));
+            view.fill(reused);
+            SKY_CHECK(same_clues(reused, problems[i]));
+            SKY_CHECK((view.solution != nullptr) == (i % 2 == 0));
+            if (view.solution != nullptr)
+                SKY_CHECK(view.to_solution().board_data == puzzles[i].solution.board_data);
+        }
+    }
+
+    // text files are packed with their solution blocks, unreadable ones are skipped
+    void test_pack(const fs::path& directory)
+    {
+        sky::puzzle_generator_t generator{32};
+        const auto with_solution = generator.generate(5);
+        const auto without_solution = generator.generate(6);
+        const auto first = (directory / "first.txt").string();
+        const auto second = (directory / "second.txt").string();
+        const auto broken = (directory / "broken.txt").string();
+        SKY_CHECK(sky::problem_to_file(first, with_solution.problem, &with_solution.solution));
+        SKY_CHECK(sky::problem_to_file(second, without_solution.problem));
+        write_bytes(broken, {'B', 'O', 'A', 'R', 'D', '_', 'S', 'I', 'Z', 'E', ':', '\t', 'x', '\n'});
+
+        const auto path = (directory / "packed.corpus").string();
+        SKY_CHECK(sky::pack_corpus(path, {first, broken, second, (directory / "missing.txt").string()}) == 2);
+        auto corpus = sky::corpus_t::open(path);
+        SKY_CHECK(corpus.has_value());
+        if (!corpus.has_value())
+            return;
+        SKY_CHECK(corpus->size() == 2);
+        SKY_CHECK(same_clues((*corpus)[0].to_problem(), with_solution.problem));
+        SKY_CHECK((*corpus)[0].solution != nullptr && (*corpus)[0].to_solution().board_data == with_solution.solution.board_data);
+        SKY_CHECK(same_clues((*corpus)[1].to_problem(), without_solution.problem));
+        SKY_CHECK((*corpus)[1].solution == nullptr);
+    }
+
+    // damaged files are rejected when opened, before any view can read out of bounds
+    void test_corrupt(const fs::path& directory)
+    {
+        sky::puzzle_generator_t generator{33};
+        const auto puzzle = generator.generate(4);
+        const auto good = (directory / "good.corpus").string();
+        SKY_CHECK(sky::write_corpus(good, {puzzle.problem, puzzle.problem}));
+        const auto bytes = read_bytes(good);
+        const auto path = (directory / "bad.corpus").string();
+
+        const auto rejected = [&path](const std::vector<char>& damaged, const sky::corpus_t::error_t expected)
+        {
+            write_bytes(path, damaged);
+            auto corpus = sky::corpus_t::open(path);
+            return !corpus.has_value() && corpus.error() == expected;
+        };
+        const auto with_u64 = [&bytes](const blt::size_t at, const blt::u64 value)
+        {
+            auto damaged = bytes;
+            std::memcpy(damaged.data() + at, &value, sizeof(value));
+            return damaged;
+        };
+
+        auto damaged = bytes;
+        damaged[0] = 'X';
+        SKY_CHECK(rejected(damaged, sky::corpus_t::error_t::BAD_MAGIC));
+        damaged = bytes;
+        damaged[offsetof(sky::corpus_header_t, version)] = 9;
+        SKY_CHECK(rejected(damaged, sky::corpus_t::error_t::UNSUPPORTED_VERSION));
+        SKY_CHECK(rejected({bytes.begin(), bytes.begin() + 10}, sky::corpus_t::error_t::TRUNCATED));
+        SKY_CHECK(rejected({bytes.begin(), bytes.end() - 1}, sky::corpus_t::error_t::TRUNCATED));
+        SKY_CHECK(rejected(with_u64(offsetof(sky::corpus_header_t, puzzle_count), ~blt::u64{0}), sky::corpus_t::error_t::TRUNCATED));
+        SKY_CHECK(rejected(with_u64(offsetof(sky::corpus_header_t, index_offset), 0), sky::corpus_t::error_t::TRUNCATED));
+
+        // record offsets near 2^64 used to wrap around the bounds check
+        const auto index = static_cast<blt::size_t>(reinterpret_cast<const sky::corpus_header_t*>(bytes.data())->index_offset);
+        for (const auto offset : {~blt::u64{0}, ~blt::u64{0} - 1, static_cast<blt::u64>(bytes.size()) - 1})
+            SKY_CHECK(rejected(with_u64(index + sizeof(blt::u64), offset), sky::corpus_t::error_t::TRUNCATED));
+
+        // a record claiming a larger board than the file has room for
+        blt::u64 first_record;
+        std::memcpy(&first_record, bytes.data() + index, sizeof(first_record));
+        damaged = bytes;
+        damaged[first_record] = static_cast<char>(200);
+        SKY_CHECK(rejected(damaged, sky::corpus_t::error_t::TRUNCATED));
+        damaged[first_record] = 0;
+        SKY_CHECK(rejected(damaged, sky::corpus_t::error_t::TRUNCATED));
+    }
+}
+
+int main()
+{
+    const auto directory = fs::temp_directory_path() / "skyscrapers-ga-corpus-test";
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+    test_round_trip(directory);
+    test_pack(directory);
+    test_corrupt(directory);
+    fs::remove_all(directory);
+    return sky::test::finish("corpus");
+}
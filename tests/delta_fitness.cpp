@@ -0,0 +1,83 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "test.h"
+#include <fitness_kernel.h>
+#include <generator.h>
+#include <skyscrapers.h>
+#include <vector>
+
+namespace
+{
+    constexpr sky::fitness_kernel_t kernels[] = {sky::fitness_kernel_t::REFERENCE, sky::fitness_kernel_t::BITMASK, sky::fitness_kernel_t::FIXED};
+
+    // boards of in range values, the precondition of every kernel but the reference one
+    std::vector<sky::solution_t> random_boards(const blt::i32 size, const blt::size_t count, blt::random::random_t& random)
+    {
+        std::vector<sky::solution_t> boards;
+        for (blt::size_t i = 0; i < count; i++)
+        {
+            boards.emplace_back(size);
+            for (auto& cell : boards.back().board_data)
+                cell = static_cast<sky::cell_t>(random.get_i32(1, size + 1));
+        }
+        return boards;
+    }
+
+    // changes a few cells, rescoring only their lines, and compares against scoring the whole board again
+    void test_delta_scores(const sky::problem_t& problem, std::vector<sky::solution_t>& boards, blt::random::random_t& random)
+    {
+        const auto size = problem.board_size;
+        const auto lines = static_cast<blt::size_t>(size) * 2;
+        for (auto& board : boards)
+        {
+            for (const auto kernel : kernels)
+            {
+                std::vector<blt::i32> line_scores(lines);
+                auto fitness = sky::score_lines(problem, board.board_data.data(), line_scores.data(), kernel);
+                sky::dirty_lines_t dirty{size};
+                for (blt::i32 change = random.get_i32(1, 4); change > 0; change--)
+                {
+                    const auto index = random.get_size_t(0, board.board_data.size());
+                    board.board_data[index] = static_cast<sky::cell_t>(random.get_i32(1, size + 1));
+                    dirty.mark_index(index);
+                }
+                sky::rescore_lines(problem, board.board_data.data(), line_scores.data(), fitness, dirty, kernel);
+
+                std::vector<blt::i32> expected(lines);
+                SKY_CHECK(fitness == sky::score_lines(problem, board.board_data.data(), expected.data(), sky::fitness_kernel_t::REFERENCE));
+                SKY_CHECK(line_scores == expected);
+            }
+        }
+    }
+}
+
+int main()
+{
+    blt::random::random_t random{44};
+    for (const auto size : {2, 3, 4, 5, 6, 7, 8, 9, 10, 12, 16, 33})
+    {
+        sky::puzzle_generator_t generator{static_cast<blt::u64>(size)};
+        auto puzzle = generator.generate(size);
+        auto boards = random_boards(size, 45, random);
+        boards.push_back(puzzle.solution);
+        // a few rounds, so later changes land on boards that were already rescored incrementally
+        for (blt::i32 round = 0; round < 4; round++)
+            test_delta_scores(puzzle.problem, boards, random);
+    }
+    return sky::test::finish("delta fitness");
+}
@@ -0,0 +1,83 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "test.h"
+#include <fitness_kernel.h>
+#include <generator.h>
+#include <skyscrapers.h>
+#include <vector>
+
+namespace
+{
+    constexpr sky::fitness_kernel_t kernels[] = {sky::fitness_kernel_t::REFERENCE, sky::fitness_kernel_t::BITMASK, sky::fitness_kernel_t::FIXED};
+
+    // boards of in range values, the precondition of every kernel but the reference one
+    std::vector<sky::solution_t> random_boards(const blt::i32 size, const blt::size_t count, blt::random::random_t& random)
+    {
+        std::vector<sky::solution_t> boards;
+        for (blt::size_t i = 0; i < count; i++)
+        {
+            boards.emplace_back(size);
+            for (auto& cell : boards.back().board_data)
+                cell = static_cast<sky::cell_t>(random.get_i32(1, size + 1));
+        }
+        return boards;
+    }
+
+    void test_full_scores(const sky::problem_t& problem, const std::vector<sky::solution_t>& boards)
+    {
+        const auto lines = static_cast<blt::size_t>(problem.board_size) * 2;
+        for (const auto& board : boards)
+        {
+            const auto expected = board.fitness(problem);
+            std::vector<blt::i32> reference_lines(lines);
+            (void) sky::score_lines(problem, board.board_data.data(), reference_lines.data(), sky::fitness_kernel_t::REFERENCE);
+            for (const auto kernel : kernels)
+            {
+                std::vector<blt::i32> line_scores(lines);
+                SKY_CHECK(board.fitness(problem, kernel) == expected);
+                SKY_CHECK(sky::score_lines(problem, board.board_data.data(), line_scores.data(), kernel) == expected);
+                SKY_CHECK(line_scores == reference_lines);
+            }
+        }
+    }
+}
+
+int main()
+{
+    blt::random::random_t random{42};
+    for (const auto size : {2, 3, 4, 5, 6, 7, 8, 9, 10, 12, 16, 33})
+    {
+        sky::puzzle_generator_t generator{static_cast<blt::u64>(size)};
+        auto puzzle = generator.generate(size);
+        auto boards = random_boards(size, 45, random);
+        // the solution itself must score zero everywhere
+        boards.push_back(puzzle.solution);
+        SKY_CHECK(puzzle.solution.fitness(puzzle.problem) == 0);
+
+        test_full_scores(puzzle.problem, boards);
+
+        // missing clues (zero or less) accept any view, so the solution still scores zero without them
+        auto missing = puzzle.problem;
+        missing.top[0] = 0;
+        missing.bottom[size - 1] = -1;
+        missing.left[size / 2] = 0;
+        SKY_CHECK(puzzle.solution.fitness(missing) == 0);
+        test_full_scores(missing, boards);
+    }
+    return sky::test::finish("fitness kernels");
+}
@@ -0,0 +1,56 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "test.h"
+#include <generator.h>
+
+namespace
+{
+    void test_generator()
+    {
+        for (const auto size : {1, 2, 4, 6, 9, 12})
+        {
+            sky::puzzle_generator_t first{static_cast<blt::u64>(size)};
+            sky::puzzle_generator_t second{static_cast<blt::u64>(size)};
+            const auto a = first.generate(size);
+            const auto b = second.generate(size);
+            SKY_CHECK(sky::test::latin(a.solution));
+            SKY_CHECK(a.solution.board_data == b.solution.board_data);
+            SKY_CHECK(a.solution.fitness(a.problem) == 0);
+            const auto clues = sky::problem_from_solution(a.solution);
+            SKY_CHECK(clues.top == a.problem.top && clues.bottom == a.problem.bottom);
+            SKY_CHECK(clues.left == a.problem.left && clues.right == a.problem.right);
+        }
+    }
+
+    // a generator hands out a sequence of puzzles, not the same one again
+    void test_sequence()
+    {
+        sky::puzzle_generator_t generator{77};
+        const auto first = generator.generate(7);
+        const auto second = generator.generate(7);
+        SKY_CHECK(sky::test::latin(second.solution));
+        SKY_CHECK(first.solution.board_data != second.solution.board_data);
+    }
+}
+
+int main()
+{
+    test_generator();
+    test_sequence();
+    return sky::test::finish("generator");
+}
@@ -0,0 +1,96 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "test.h"
+#include <algorithm>
+#include <generator.h>
+#include <island_model.h>
+#include <memory>
+
+namespace
+{
+    // a newer batch replaces one not yet taken, and taking empties the mailbox
+    void test_mailbox()
+    {
+        sky::migrant_mailbox_t mailbox;
+        SKY_CHECK(mailbox.take() == nullptr);
+        mailbox.post(std::make_unique<std::vector<sky::individual_t>>(1));
+        mailbox.post(std::make_unique<std::vector<sky::individual_t>>(3));
+        const auto taken = mailbox.take();
+        SKY_CHECK(taken != nullptr && taken->size() == 3);
+        SKY_CHECK(mailbox.take() == nullptr);
+    }
+
+    std::vector<blt::u64> run(const sky::problem_t& problem, const sky::migration_topology_t topology, const blt::u64 seed)
+    {
+        const std::vector<sky::island_config_t> configs{{120, 0.8, 0.1}, {80, 0.6, 0.3}, {100, 0.7, 0.2}};
+        sky::island_model_t model{problem, configs, 5, 2, topology, seed};
+        model.set_lockstep(true);
+        model.run(40);
+        std::vector<blt::u64> digests;
+        for (blt::size_t i = 0; i < model.island_count(); i++)
+            digests.push_back(sky::test::digest(model.get_island(i)));
+        return digests;
+    }
+
+    // lockstep runs only depend on their seed, whatever the thread timing
+    void test_lockstep(const sky::problem_t& problem)
+    {
+        for (const auto topology : {sky::migration_topology_t::RING, sky::migration_topology_t::RANDOM})
+        {
+            const auto expected = run(problem, topology, 21);
+            SKY_CHECK(run(problem, topology, 21) == expected);
+            SKY_CHECK(run(problem, topology, 21) == expected);
+            SKY_CHECK(run(problem, topology, 22) != expected);
+        }
+    }
+
+    void test_solve(const sky::generated_puzzle_t& puzzle)
+    {
+        for (const auto lockstep : {false, true})
+        {
+            const std::vector<sky::island_config_t> configs(4, sky::island_config_t{200, 0.8, 0.1});
+            sky::island_model_t model{puzzle.problem, configs, 5, 2, sky::migration_topology_t::RING, 8};
+            model.set_lockstep(lockstep);
+            const auto generations = model.run(2000);
+            SKY_CHECK(generations > 0 && generations <= 2000);
+
+            const auto best = model.get_best(3);
+            SKY_CHECK(best.size() == 3);
+            if (best.empty())
+                continue;
+            SKY_CHECK(best.front().fitness == 0);
+            SKY_CHECK(sky::test::latin(best.front().solution));
+            SKY_CHECK(best.front().solution.fitness(puzzle.problem) == 0);
+            for (blt::size_t i = 1; i < best.size(); i++)
+                SKY_CHECK(best[i - 1].fitness <= best[i].fitness);
+            // the best of every island is no better than the overall best
+            for (blt::size_t i = 0; i < model.island_count(); i++)
+                SKY_CHECK(model.get_island(i).best_fitness() >= best.front().fitness);
+        }
+    }
+}
+
+int main()
+{
+    sky::puzzle_generator_t generator{4};
+    const auto puzzle = generator.generate(5);
+    test_mailbox();
+    test_lockstep(generator.generate(6).problem);
+    test_solve(puzzle);
+    return sky::test::finish("islands");
+}
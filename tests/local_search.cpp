@@ -0,0 +1,146 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "test.h"
+#include <algorithm>
+#include <cstring>
+#include <generator.h>
+#include <local_search.h>
+#include <numeric>
+
+namespace
+{
+    // every row a random permutation, so swaps inside a row keep it one
+    sky::population_t random_population(const sky::problem_t& problem, const blt::size_t count, const blt::u64 seed)
+    {
+        const auto size = problem.board_size;
+        sky::population_t population{size, count};
+        blt::random::random_t random{seed};
+        for (blt::size_t i = 0; i < count; i++)
+        {
+            auto* cells = population.cells(i);
+            for (blt::i32 row = 0; row < size; row++)
+            {
+                std::iota(cells + row * size, cells + (row + 1) * size, static_cast<sky::cell_t>(1));
+                for (blt::i32 j = size - 1; j > 0; j--)
+                    std::swap(cells[row * size + j], cells[row * size + random.get_i32(0, j + 1)]);
+            }
+            population.evaluate(i, problem, sky::fitness_kernel_t::REFERENCE);
+        }
+        return population;
+    }
+
+    // the search may only swap cells inside a row, never moves a fixed cell and leaves scores that match a full rescore
+    void check_result(const sky::problem_t& problem, const sky::population_t& before, sky::population_t& after, const blt::size_t index,
+                      const blt::i32 improvement)
+    {
+        const auto size = problem.board_size;
+        SKY_CHECK(improvement >= 0);
+        SKY_CHECK(before.fitness(index) - after.fitness(index) == improvement);
+        for (blt::i32 row = 0; row < size; row++)
+        {
+            std::vector<sky::cell_t> old_row(before.cells(index) + row * size, before.cells(index) + (row + 1) * size);
+            std::vector<sky::cell_t> new_row(after.cells(index) + row * size, after.cells(index) + (row + 1) * size);
+            std::sort(old_row.begin(), old_row.end());
+            std::sort(new_row.begin(), new_row.end());
+            SKY_CHECK(old_row == new_row);
+        }
+        for (const auto cell : problem.get_fixed_cells())
+            SKY_CHECK(before.cells(index)[cell] == after.cells(index)[cell]);
+
+        std::vector<blt::i32> scores(after.line_scores(index), after.line_scores(index) + size * 2);
+        const auto fitness = after.fitness(index);
+        after.evaluate(index, problem, sky::fitness_kernel_t::REFERENCE);
+        SKY_CHECK(after.fitness(index) == fitness);
+        SKY_CHECK(std::equal(scores.begin(), scores.end(), after.line_scores(index)));
+    }
+
+    void test_searches(const sky::problem_t& problem)
+    {
+        const auto before = random_population(problem, 20, 7);
+        for (const auto kernel : {sky::fitness_kernel_t::REFERENCE, sky::fitness_kernel_t::BITMASK, sky::fitness_kernel_t::FIXED})
+        {
+            auto climbed = before;
+            auto searched = before;
+            blt::random::random_t random{9};
+            blt::i32 climbed_total = 0, searched_total = 0;
+            for (blt::size_t i = 0; i < before.size(); i++)
+            {
+                const auto climb = sky::hill_climb(problem, climbed, i, kernel, random, 200);
+                check_result(problem, before, climbed, i, climb);
+                const auto tabu = sky::tabu_search(problem, searched, i, kernel, 50, 4);
+                check_result(problem, before, searched, i, tabu);
+                climbed_total += climb;
+                searched_total += tabu;
+            }
+            // random boards are far from solved, both searches should find something to improve
+            SKY_CHECK(climbed_total > 0);
+            SKY_CHECK(searched_total > 0);
+        }
+    }
+
+    // no moves allowed leaves the board as it was
+    void test_no_moves(const sky::problem_t& problem)
+    {
+        const auto before = random_population(problem, 4, 11);
+        auto after = before;
+        blt::random::random_t random{1};
+        for (blt::size_t i = 0; i < before.size(); i++)
+        {
+            SKY_CHECK(sky::hill_climb(problem, after, i, sky::fitness_kernel_t::BITMASK, random, 0) == 0);
+            SKY_CHECK(sky::tabu_search(problem, after, i, sky::fitness_kernel_t::BITMASK, 0, 4) == 0);
+            SKY_CHECK(std::memcmp(before.cells(i), after.cells(i), static_cast<blt::size_t>(problem.board_size) * problem.board_size) == 0);
+        }
+    }
+
+    // refined elites keep their cached hash and scores in line with their cells
+    void test_refined_run(const sky::problem_t& problem)
+    {
+        for (const auto mode : {sky::local_search_t::HILL_CLIMB, sky::local_search_t::TABU})
+        {
+            sky::genetic_algorithm ga{problem, 100, 0.8, 0.1, 23};
+            ga.set_local_search({mode, 4, 50, 4});
+            auto best = ga.best_fitness();
+            for (blt::i32 step = 0; step < 20; step++)
+            {
+                ga.run_step();
+                SKY_CHECK(ga.best_fitness() <= best);
+                best = ga.best_fitness();
+            }
+            auto population = ga.get_population();
+            for (blt::size_t i = 0; i < population.size(); i++)
+            {
+                const auto hash = population.hash(i);
+                const auto fitness = population.fitness(i);
+                population.evaluate(i, problem, sky::fitness_kernel_t::REFERENCE);
+                SKY_CHECK(population.hash(i) == hash);
+                SKY_CHECK(population.fitness(i) == fitness);
+            }
+        }
+    }
+}
+
+int main()
+{
+    sky::puzzle_generator_t generator{12};
+    auto puzzle = generator.generate(6);
+    puzzle.problem.propagate_domains();
+    test_searches(puzzle.problem);
+    test_no_moves(puzzle.problem);
+    test_refined_run(puzzle.problem);
+    return sky::test::finish("local search");
+}
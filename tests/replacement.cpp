@@ -0,0 +1,141 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "test.h"
+#include <algorithm>
+#include <fitness_kernel.h>
+#include <generator.h>
+
+namespace
+{
+    // every length crosses the vector, word and tail loops differently, the offsets make the loads unaligned
+    void test_hamming()
+    {
+        blt::random::random_t random{41};
+        std::vector<sky::cell_t> a(160), b(160);
+        for (blt::size_t count = 0; count <= 130; count++)
+        {
+            for (const blt::size_t offset : {0, 1, 7, 29})
+            {
+                for (blt::size_t i = 0; i < a.size(); i++)
+                {
+                    a[i] = static_cast<sky::cell_t>(random.get_i32(1, 256));
+                    // mostly equal, with differences in single bits and whole bytes
+                    const auto pick = random.get_i32(0, 4);
+                    b[i] = static_cast<sky::cell_t>(pick == 0 ? a[i] ^ 1 << random.get_i32(0, 8) : pick == 1 ? ~a[i] : a[i]);
+                }
+                blt::size_t expected = 0;
+                for (blt::size_t i = 0; i < count; i++)
+                    expected += a[offset + i] != b[offset + i];
+                SKY_CHECK(sky::kernel::hamming_distance(a.data() + offset, b.data() + offset, count) == expected);
+                SKY_CHECK(sky::kernel::hamming_distance(a.data() + offset, a.data() + offset, count) == 0);
+            }
+        }
+    }
+
+    void test_diversity()
+    {
+        blt::random::random_t random{3};
+        sky::population_t population{4, 10};
+        for (blt::size_t i = 0; i < population.size(); i++)
+            std::fill_n(population.cells(i), 16, static_cast<sky::cell_t>(1));
+        SKY_CHECK(population.diversity(50, random) == 0);
+        SKY_CHECK(population.distance(0, population.cells(1)) == 0);
+
+        // every board differs from every other one in every cell
+        for (blt::size_t i = 0; i < population.size(); i++)
+            std::fill_n(population.cells(i), 16, static_cast<sky::cell_t>(i + 1));
+        SKY_CHECK(population.diversity(50, random) == 1);
+        SKY_CHECK(population.distance(2, population.cells(5)) == 16);
+        population.cells(5)[3] = 3;
+        SKY_CHECK(population.distance(2, population.cells(5)) == 15);
+        SKY_CHECK(population.diversity(0, random) == 0);
+    }
+
+    // under crowding each slot holds the fitter of a child and the parent it contested, and every member parents exactly one slot, so
+    // without elites the average can only go down
+    void test_crowding(const sky::problem_t& problem)
+    {
+        sky::genetic_algorithm ga{problem, 120, 0.8, 0.2, 51};
+        ga.set_replacement({sky::replacement_t::DETERMINISTIC_CROWDING});
+        blt::u64 rejections = 0;
+        for (blt::i32 step = 0; step < 40; step++)
+        {
+            const auto average = ga.average_fitness();
+            ga.run_step(0);
+            SKY_CHECK(ga.average_fitness() <= average);
+            rejections += ga.get_last_rejections();
+        }
+        SKY_CHECK(rejections > 0);
+    }
+
+    // sharing may keep a worse board for the sake of its niche, but contests still happen and solutions are never given up
+    void test_sharing(const sky::problem_t& problem)
+    {
+        sky::genetic_algorithm ga{problem, 120, 0.8, 0.2, 51};
+        ga.set_replacement({sky::replacement_t::FITNESS_SHARING, 0.3, 12});
+        blt::u64 rejections = 0;
+        for (blt::i32 step = 0; step < 40; step++)
+        {
+            ga.run_step();
+            rejections += ga.get_last_rejections();
+        }
+        SKY_CHECK(rejections > 0);
+
+        sky::genetic_algorithm generational{problem, 120, 0.8, 0.2, 51};
+        for (blt::i32 step = 0; step < 40; step++)
+        {
+            generational.run_step();
+            SKY_CHECK(generational.get_last_rejections() == 0);
+        }
+        // niches survive, where generational replacement converges
+        SKY_CHECK(ga.get_last_diversity() > generational.get_last_diversity());
+    }
+
+    void test_workers(const sky::problem_t& problem)
+    {
+        for (const auto mode : {sky::replacement_t::DETERMINISTIC_CROWDING, sky::replacement_t::FITNESS_SHARING})
+        {
+            const auto run = [&problem, mode](const blt::size_t workers, const sky::evaluation_t evaluation)
+            {
+                sky::genetic_algorithm ga{problem, 151, 0.8, 0.2, 61};
+                ga.set_replacement({mode});
+                ga.set_evaluation(evaluation);
+                ga.set_worker_count(workers);
+                for (blt::i32 step = 0; step < 30; step++)
+                    ga.run_step();
+                return sky::test::digest(ga);
+            };
+            const auto expected = run(1, sky::evaluation_t::INLINE);
+            SKY_CHECK(run(3, sky::evaluation_t::INLINE) == expected);
+            SKY_CHECK(run(1, sky::evaluation_t::BATCHED) == expected);
+            SKY_CHECK(run(4, sky::evaluation_t::BATCHED) == expected);
+        }
+    }
+}
+
+int main()
+{
+    sky::puzzle_generator_t generator{23};
+    const auto puzzle = generator.generate(7);
+    test_hamming();
+    test_diversity();
+    test_crowding(puzzle.problem);
+    test_sharing(puzzle.problem);
+    test_workers(puzzle.problem);
+    return sky::test::finish("replacement");
+}
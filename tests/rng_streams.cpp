@@ -0,0 +1,100 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "test.h"
+#include <generator.h>
+#include <genetic_algorithm.h>
+#include <rng.h>
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    void test_streams()
+    {
+        // positions are pure functions of the key, and neighbouring streams and positions do not repeat each other
+        constexpr blt::u64 key = 1234;
+        std::vector<blt::u64> values;
+        for (blt::u64 id = 0; id < 16; id++)
+        {
+            const auto child = sky::rng::stream(key, id);
+            SKY_CHECK(child == sky::rng::stream(key, id));
+            for (blt::u64 position = 0; position < 16; position++)
+                values.push_back(sky::rng::at(child, position));
+        }
+        std::sort(values.begin(), values.end());
+        SKY_CHECK(std::adjacent_find(values.begin(), values.end()) == values.end());
+
+        blt::u64 filled[40];
+        sky::rng::fill(key, 3, filled, 40);
+        for (blt::u64 i = 0; i < 40; i++)
+            SKY_CHECK(filled[i] == sky::rng::at(key, 3 + i));
+
+        sky::cell_t cells[200];
+        sky::rng::fill_cells(key, 0, cells, 200, 2, 7);
+        for (const auto cell : cells)
+            SKY_CHECK(cell >= 2 && cell <= 7);
+    }
+
+    blt::u64 run(const sky::problem_t& problem, const blt::u64 seed, const blt::size_t workers, const blt::i32 variant)
+    {
+        sky::genetic_algorithm ga{problem, 200, 0.8, 0.1, seed};
+        ga.set_worker_count(workers);
+        if (variant == 1)
+        {
+            ga.set_selection(sky::selection_t::STOCHASTIC_UNIVERSAL);
+            ga.set_duplicate_policy(sky::duplicate_policy_t::REMUTATE);
+            ga.set_replacement({sky::replacement_t::FITNESS_SHARING});
+            ga.set_evaluation(sky::evaluation_t::BATCHED);
+        }
+        else if (variant == 2)
+        {
+            ga.set_selection(sky::selection_t::RANK);
+            ga.set_encoding(sky::encoding_t::ROW_PERMUTATION);
+            ga.set_replacement({sky::replacement_t::DETERMINISTIC_CROWDING});
+            ga.set_fitness_cache(4096);
+        }
+        for (blt::i32 generation = 0; generation < 30; generation++)
+        {
+            ga.run_step();
+            if (generation == 15)
+                ga.reseed(0.25);
+        }
+        return sky::test::digest(ga);
+    }
+
+    // the same seed gives the same run however the work is split between threads, another seed gives another run
+    void test_runs(const sky::problem_t& problem)
+    {
+        for (blt::i32 variant = 0; variant < 3; variant++)
+        {
+            const auto expected = run(problem, 7, 1, variant);
+            SKY_CHECK(run(problem, 7, 1, variant) == expected);
+            SKY_CHECK(run(problem, 7, 3, variant) == expected);
+            SKY_CHECK(run(problem, 7, 4, variant) == expected);
+            SKY_CHECK(run(problem, 8, 1, variant) != expected);
+        }
+    }
+}
+
+int main()
+{
+    test_streams();
+    sky::puzzle_generator_t generator{5};
+    test_runs(generator.generate(6).problem);
+    return sky::test::finish("rng streams");
+}
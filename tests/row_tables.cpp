@@ -0,0 +1,104 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "test.h"
+#include <algorithm>
+#include <checkpoint.h>
+#include <cstdio>
+#include <fitness_kernel.h>
+#include <generator.h>
+#include <row_table.h>
+
+namespace
+{
+    // the row is a permutation of 1..N and sees what its left / right clues ask for
+    bool fits(const sky::problem_t& problem, const blt::i32 row, const sky::cell_t* cells)
+    {
+        const auto size = problem.board_size;
+        std::vector<sky::cell_t> board(static_cast<blt::size_t>(size) * size);
+        std::copy(cells, cells + size, board.begin() + static_cast<blt::size_t>(row) * size);
+        return sky::kernel::reference_row_incorrect_count(board.data(), size, row) == 0 &&
+            sky::kernel::reference_row_view_count(problem, board.data(), row) == 0;
+    }
+
+    void test_rows(const blt::i32 size, const blt::size_t max_row_entries)
+    {
+        sky::puzzle_generator_t generator{static_cast<blt::u64>(size) * 31};
+        auto puzzle = generator.generate(size);
+        puzzle.problem.propagate_domains();
+
+        sky::row_tables_t tables;
+        tables.build(puzzle.problem, max_row_entries);
+        SKY_CHECK(tables.get_max_row_entries() == max_row_entries);
+        blt::random::random_t random{static_cast<blt::u64>(size)};
+        std::vector<sky::cell_t> cells(size);
+        for (blt::i32 row = 0; row < size; row++)
+        {
+            SKY_CHECK(tables.enumerated(row) || tables.size(row) == 0);
+            SKY_CHECK(!tables.enumerated(row) || tables.size(row) <= max_row_entries);
+            for (blt::size_t i = 0; i < tables.size(row); i++)
+                SKY_CHECK(fits(puzzle.problem, row, tables.entry(row, i)));
+            for (blt::i32 sample = 0; sample < 20; sample++)
+            {
+                tables.sample(puzzle.problem, row, random, cells.data());
+                SKY_CHECK(fits(puzzle.problem, row, cells.data()));
+                if (tables.enumerated(row))
+                    SKY_CHECK(tables.find(row, cells.data()) < tables.size(row));
+            }
+        }
+    }
+
+    // a resumed run rebuilds its tables with the limit the original was given, so it samples the same rows the same way
+    void test_resume()
+    {
+        const char* path = "skyscrapers-ga-row-tables.ckpt";
+        constexpr blt::size_t max_row_entries = 3;
+        sky::puzzle_generator_t generator{9};
+        const auto puzzle = generator.generate(6);
+        sky::genetic_algorithm original{puzzle.problem, 60, 0.7, 0.2, 13};
+        original.set_encoding(sky::encoding_t::ROW_PERMUTATION, max_row_entries);
+        for (blt::i32 generation = 0; generation < 5; generation++)
+            original.run_step();
+        SKY_CHECK(sky::save_checkpoint(path, original));
+        {
+            const auto checkpoint = sky::checkpoint_t::open(path);
+            SKY_CHECK(checkpoint.has_value());
+            if (!checkpoint.has_value())
+                return;
+            SKY_CHECK(checkpoint.value().header().max_row_entries == max_row_entries);
+            sky::genetic_algorithm resumed{checkpoint.value()};
+            SKY_CHECK(resumed.get_row_tables().get_max_row_entries() == max_row_entries);
+            SKY_CHECK(resumed.get_row_tables().entry_count() == original.get_row_tables().entry_count());
+            for (blt::i32 generation = 0; generation < 5; generation++)
+            {
+                original.run_step();
+                resumed.run_step();
+            }
+            SKY_CHECK(sky::test::digest(resumed) == sky::test::digest(original));
+        }
+        std::remove(path);
+    }
+}
+
+int main()
+{
+    test_rows(5, sky::row_tables_t::default_max_row_entries);
+    test_rows(7, 10);
+    test_rows(12, sky::row_tables_t::default_max_row_entries);
+    test_resume();
+    return sky::test::finish("row tables");
+}
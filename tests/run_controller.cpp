@@ -0,0 +1,178 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "test.h"
+#include <algorithm>
+#include <generator.h>
+#include <run_controller.h>
+
+namespace
+{
+    void test_generation_limit(const sky::problem_t& problem)
+    {
+        sky::genetic_algorithm ga{problem, 100, 0.8, 0.1, 3};
+        sky::run_controller_config_t config;
+        config.max_generations = 15;
+        sky::run_controller_t controller{config};
+        blt::i32 calls = 0;
+        blt::i32 best = ga.best_fitness();
+        controller.set_generation_callback([&](const sky::generation_stats_t& stats)
+        {
+            SKY_CHECK(stats.generation == ++calls);
+            SKY_CHECK(stats.best_fitness <= best);
+            best = stats.best_fitness;
+        });
+        const auto report = controller.run(ga);
+        SKY_CHECK(report.reason == sky::stop_reason_t::GENERATION_LIMIT);
+        SKY_CHECK(report.generations == 15 && calls == 15);
+        SKY_CHECK(report.best_fitness == ga.best_fitness());
+        SKY_CHECK(ga.get_generation() == 15);
+    }
+
+    void test_solved(const sky::problem_t& problem)
+    {
+        sky::genetic_algorithm ga{problem, 200, 0.8, 0.1, 5};
+        sky::run_controller_config_t config;
+        config.max_generations = 5000;
+        const auto report = sky::run_controller_t{config}.run(ga);
+        SKY_CHECK(report.reason == sky::stop_reason_t::SOLVED);
+        SKY_CHECK(report.best_fitness == 0 && ga.best_fitness() == 0);
+        SKY_CHECK(report.generations < 5000);
+    }
+
+    void test_limits(const sky::problem_t& problem)
+    {
+        {
+            sky::genetic_algorithm ga{problem, 100, 0.8, 0.1, 7};
+            sky::run_controller_config_t config;
+            config.max_generations = 1 << 30;
+            config.time_limit_seconds = 0.05;
+            const auto report = sky::run_controller_t{config}.run(ga);
+            SKY_CHECK(report.reason == sky::stop_reason_t::TIME_LIMIT);
+            SKY_CHECK(report.seconds >= 0.05);
+        }
+        {
+            // the predicate is asked before every generation
+            sky::genetic_algorithm ga{problem, 100, 0.8, 0.1, 7};
+            sky::run_controller_t controller;
+            blt::i32 asked = 0;
+            controller.set_stop_predicate([&asked]()
+            {
+                return ++asked > 3;
+            });
+            const auto report = controller.run(ga);
+            SKY_CHECK(report.reason == sky::stop_reason_t::INTERRUPTED);
+            SKY_CHECK(report.generations == 3);
+        }
+    }
+
+    // a diversity floor above anything measurable makes every window without a new best count as stagnation
+    sky::run_controller_config_t stagnating(const sky::restart_policy_t policy)
+    {
+        sky::run_controller_config_t config;
+        config.max_generations = 300;
+        config.window = 5;
+        config.min_diversity = 2;
+        config.policy = policy;
+        return config;
+    }
+
+    void test_stagnation(const sky::problem_t& problem)
+    {
+        {
+            sky::genetic_algorithm ga{problem, 40, 0.8, 0.1, 9};
+            const auto report = sky::run_controller_t{stagnating(sky::restart_policy_t::NONE)}.run(ga);
+            SKY_CHECK(report.stagnations > 0);
+            SKY_CHECK(report.restarts == 0);
+            // a stagnation resets the window, so there is at most one per window
+            SKY_CHECK(report.stagnations <= report.generations / 5);
+        }
+        {
+            sky::genetic_algorithm ga{problem, 40, 0.8, 0.1, 9};
+            auto config = stagnating(sky::restart_policy_t::PARTIAL_RESTART);
+            config.max_restarts = 2;
+            blt::i32 best = ga.best_fitness();
+            sky::run_controller_t controller{config};
+            // restarts keep the elites, the best never gets worse
+            controller.set_generation_callback([&best](const sky::generation_stats_t& stats)
+            {
+                SKY_CHECK(stats.best_fitness <= best);
+                best = stats.best_fitness;
+            });
+            const auto report = controller.run(ga);
+            SKY_CHECK(report.restarts == 2);
+            SKY_CHECK(report.stagnations >= 2);
+        }
+        {
+            sky::genetic_algorithm ga{problem, 40, 0.8, 0.1, 9};
+            auto config = stagnating(sky::restart_policy_t::ADAPT_RATES);
+            double highest_share = 0;
+            sky::run_controller_t controller{config};
+            controller.set_generation_callback([&ga, &highest_share](const sky::generation_stats_t&)
+            {
+                const auto total = ga.get_crossover_rate() + ga.get_mutation_rate();
+                SKY_CHECK(total > 0.89 && total < 0.91);
+                highest_share = std::max(highest_share, ga.get_mutation_rate() / total);
+            });
+            const auto report = controller.run(ga);
+            SKY_CHECK(report.stagnations > 0);
+            SKY_CHECK(highest_share > 0.1 / 0.9 + 1e-9);
+            SKY_CHECK(highest_share <= config.max_mutation_share + 1e-9);
+            // the starting rates are back once the run ends
+            SKY_CHECK(ga.get_crossover_rate() == 0.8 && ga.get_mutation_rate() == 0.1);
+        }
+    }
+
+    // restarts replace the worst members with fresh boards, keeping the requested best ones and their scores consistent
+    void test_reseed(const sky::problem_t& problem)
+    {
+        sky::genetic_algorithm ga{problem, 60, 0.8, 0.1, 13};
+        for (blt::i32 step = 0; step < 10; step++)
+            ga.run_step();
+        const auto best = ga.best_fitness();
+        const auto before = sky::test::digest(ga);
+        ga.reseed(0.5, 2);
+        SKY_CHECK(ga.best_fitness() == best);
+        SKY_CHECK(sky::test::digest(ga) != before);
+        auto population = ga.get_population();
+        for (blt::size_t i = 0; i < population.size(); i++)
+        {
+            const auto fitness = population.fitness(i);
+            const auto hash = population.hash(i);
+            population.evaluate(i, problem, sky::fitness_kernel_t::REFERENCE);
+            SKY_CHECK(population.fitness(i) == fitness && population.hash(i) == hash);
+        }
+        // nothing to replace
+        const auto reseeded = sky::test::digest(ga);
+        ga.reseed(0, 2);
+        ga.reseed(1, static_cast<blt::i32>(population.size()));
+        SKY_CHECK(sky::test::digest(ga) == reseeded);
+    }
+}
+
+int main()
+{
+    sky::puzzle_generator_t generator{14};
+    const auto hard = generator.generate(8);
+    const auto easy = generator.generate(4);
+    test_generation_limit(hard.problem);
+    test_solved(easy.problem);
+    test_limits(hard.problem);
+    test_stagnation(hard.problem);
+    test_reseed(hard.problem);
+    return sky::test::finish("run controller");
+}
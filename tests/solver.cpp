@@ -0,0 +1,111 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "test.h"
+#include <fitness_kernel.h>
+#include <generator.h>
+#include <solver.h>
+
+namespace
+{
+    void test_solver()
+    {
+        for (blt::u64 seed = 0; seed < 8; seed++)
+        {
+            sky::puzzle_generator_t generator{100 + seed};
+            const auto size = static_cast<blt::i32>(3 + seed % 5);
+            const auto puzzle = generator.generate(size);
+            sky::backtracking_solver_t solver{puzzle.problem};
+            const auto solution = solver.solve();
+            SKY_CHECK(solution.has_value());
+            if (solution.has_value())
+            {
+                SKY_CHECK(sky::test::latin(solution.value()));
+                SKY_CHECK(solution.value().fitness(puzzle.problem) == 0);
+            }
+        }
+
+        // no 2x2 row is seen as 2 from both ends
+        sky::problem_t impossible{2};
+        impossible.top = {1, 2};
+        impossible.bottom = {2, 1};
+        impossible.left = {2, 1};
+        impossible.right = {2, 2};
+        sky::backtracking_solver_t solver{impossible};
+        const auto result = solver.solve();
+        SKY_CHECK(!result.has_value() && result.error() == sky::backtracking_solver_t::error_t::NO_SOLUTION);
+
+        sky::puzzle_generator_t generator{3};
+        sky::backtracking_solver_t limited{generator.generate(9).problem};
+        const auto partial = limited.solve(1);
+        SKY_CHECK(!partial.has_value() && partial.error() == sky::backtracking_solver_t::error_t::NODE_LIMIT_REACHED);
+    }
+
+    // a missing clue accepts any view, so the solver's answer must still score zero with every kernel
+    void test_missing_clues()
+    {
+        for (blt::u64 seed = 0; seed < 6; seed++)
+        {
+            sky::puzzle_generator_t generator{200 + seed};
+            const auto size = static_cast<blt::i32>(4 + seed % 3);
+            auto problem = generator.generate(size).problem;
+            blt::random::random_t random{seed};
+            for (blt::i32 i = 0; i < size; i++)
+            {
+                for (auto* side : {&problem.top, &problem.bottom, &problem.left, &problem.right})
+                {
+                    if (random.choice(0.4))
+                        (*side)[i] = random.choice() ? 0 : -1;
+                }
+            }
+            problem.top[0] = 0;
+
+            sky::backtracking_solver_t solver{problem};
+            const auto solution = solver.solve();
+            SKY_CHECK(solution.has_value());
+            if (!solution.has_value())
+                continue;
+            SKY_CHECK(sky::test::latin(solution.value()));
+            for (const auto kernel : {sky::fitness_kernel_t::REFERENCE, sky::fitness_kernel_t::BITMASK, sky::fitness_kernel_t::FIXED})
+                SKY_CHECK(solution.value().fitness(problem, kernel) == 0);
+
+            // the same holds with propagated domains
+            auto propagated = problem;
+            SKY_CHECK(propagated.propagate_domains());
+            sky::backtracking_solver_t domain_solver{propagated};
+            const auto with_domains = domain_solver.solve();
+            SKY_CHECK(with_domains.has_value() && with_domains.value().fitness(problem) == 0);
+        }
+
+        // with no clues at all any latin square is a solution
+        sky::problem_t unclued{5};
+        unclued.top.assign(5, 0);
+        unclued.bottom.assign(5, 0);
+        unclued.left.assign(5, 0);
+        unclued.right.assign(5, 0);
+        sky::backtracking_solver_t solver{unclued};
+        const auto solution = solver.solve();
+        SKY_CHECK(solution.has_value() && sky::test::latin(solution.value()) && solution.value().fitness(unclued) == 0);
+    }
+}
+
+int main()
+{
+    test_solver();
+    test_missing_clues();
+    return sky::test::finish("solver");
+}
@@ -0,0 +1,145 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "test.h"
+#include <algorithm>
+#include <fitness_heap.h>
+#include <generator.h>
+#include <hashing.h>
+#include <map>
+#include <set>
+
+namespace
+{
+    // both ends of the heap always hold the lowest and highest fitness, however members are updated
+    void test_heap()
+    {
+        blt::random::random_t random{3};
+        for (blt::i32 trial = 0; trial < 50; trial++)
+        {
+            std::vector<blt::i32> fitness(random.get_size_t(1, 200));
+            for (auto& value : fitness)
+                value = random.get_i32(0, 20);
+            sky::fitness_heap_t heap;
+            heap.build(fitness);
+            SKY_CHECK(heap.size() == fitness.size());
+            for (blt::i32 update = 0; update < 200; update++)
+            {
+                const auto index = random.get_size_t(0, fitness.size());
+                fitness[index] = random.get_i32(0, 20);
+                heap.update(index, fitness[index]);
+                const auto [lowest, highest] = std::minmax_element(fitness.begin(), fitness.end());
+                SKY_CHECK(heap.fitness(heap.best()) == *lowest);
+                SKY_CHECK(heap.fitness(heap.worst()) == *highest);
+                SKY_CHECK(heap.fitness(index) == fitness[index]);
+            }
+        }
+    }
+
+    // the counter agrees with a plain map, including hashes that collide on every probe
+    void test_hash_counter()
+    {
+        blt::random::random_t random{5};
+        sky::hash_counter_t counter;
+        std::map<blt::u64, blt::i32> expected;
+        std::vector<blt::u64> added;
+        counter.reset(64);
+        for (blt::i32 operation = 0; operation < 20000; operation++)
+        {
+            // few distinct low bits, so probe runs grow long and wrap around the table
+            const auto hash = random.get_u64(0, 8) << 32 | random.get_u64(0, 4);
+            if (!added.empty() && (added.size() >= 64 || random.get_i32(0, 2) == 0))
+            {
+                const auto at = random.get_size_t(0, added.size());
+                counter.remove(added[at]);
+                if (--expected[added[at]] == 0)
+                    expected.erase(added[at]);
+                added[at] = added.back();
+                added.pop_back();
+            } else
+            {
+                counter.add(hash);
+                ++expected[hash];
+                added.push_back(hash);
+            }
+            for (blt::u64 high = 0; high < 8; high++)
+            {
+                for (blt::u64 low = 0; low < 4; low++)
+                    SKY_CHECK(counter.contains(high << 32 | low) == (expected.count(high << 32 | low) != 0));
+            }
+        }
+    }
+
+    blt::size_t distinct(const sky::population_t& population)
+    {
+        std::set<blt::u64> hashes;
+        for (blt::size_t i = 0; i < population.size(); i++)
+            hashes.insert(population.hash(i));
+        return hashes.size();
+    }
+
+    // a child never replaces a fitter member, the best is kept and a rejecting policy never lets a board in twice
+    void test_steady_step(const sky::problem_t& problem)
+    {
+        for (const auto victim : {sky::steady_victim_t::WORST, sky::steady_victim_t::TOURNAMENT_LOSER})
+        {
+            sky::genetic_algorithm ga{problem, 200, 0.8, 0.1, 17};
+            ga.set_steady_state({16, victim});
+            ga.set_duplicate_policy(sky::duplicate_policy_t::REPLACE);
+            auto best = ga.best_fitness();
+            auto unique = distinct(ga.get_population());
+            for (blt::i32 step = 0; step < 100; step++)
+            {
+                ga.run_step();
+                SKY_CHECK(ga.get_population().size() == 200);
+                SKY_CHECK(ga.best_fitness() <= best);
+                SKY_CHECK(distinct(ga.get_population()) >= unique);
+                best = ga.best_fitness();
+                unique = distinct(ga.get_population());
+            }
+        }
+    }
+
+    // the batch is inserted in birth order, so workers only change who breeds it
+    void test_workers(const sky::problem_t& problem)
+    {
+        const auto run = [&problem](const blt::size_t workers)
+        {
+            sky::genetic_algorithm ga{problem, 300, 0.8, 0.1, 11};
+            ga.set_steady_state({24, sky::steady_victim_t::TOURNAMENT_LOSER});
+            ga.set_duplicate_policy(sky::duplicate_policy_t::REMUTATE);
+            ga.set_worker_count(workers);
+            for (blt::i32 step = 0; step < 60; step++)
+                ga.run_step();
+            return sky::test::digest(ga);
+        };
+        const auto expected = run(1);
+        SKY_CHECK(run(3) == expected);
+        SKY_CHECK(run(4) == expected);
+    }
+}
+
+int main()
+{
+    sky::puzzle_generator_t generator{3};
+    const auto puzzle = generator.generate(7);
+    test_heap();
+    test_hash_counter();
+    test_steady_step(puzzle.problem);
+    test_workers(puzzle.problem);
+    return sky::test::finish("steady state");
+}
@@ -0,0 +1,183 @@
+/*
+ *  <Short Description>
+ *  Copyright (C) 2025  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "test.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <generator.h>
+#include <iterator>
+#include <string>
+#include <telemetry.h>
+#include <thread>
+
+namespace
+{
+    sky::generation_record_t make_record(const blt::u64 generation)
+    {
+        sky::generation_record_t record{};
+        record.generation = generation;
+        record.evaluations = generation * 3;
+        record.best_fitness = static_cast<blt::i32>(generation % 17);
+        record.average_fitness = static_cast<double>(generation) / 4;
+        return record;
+    }
+
+    // records come out in the order they went in, a full ring drops and counts instead of overwriting
+    void test_ring()
+    {
+        sky::telemetry_ring_t ring{5};
+        sky::generation_record_t record{};
+        SKY_CHECK(!ring.pop(record));
+        for (blt::u64 i = 0; i < 8; i++)
+            SKY_CHECK(ring.push(make_record(i)));
+        SKY_CHECK(!ring.push(make_record(8)));
+        SKY_CHECK(ring.get_dropped() == 1);
+        for (blt::u64 i = 0; i < 8; i++)
+            SKY_CHECK(ring.pop(record) && record.generation == i);
+        SKY_CHECK(!ring.pop(record));
+
+        // wrap around the storage many times, with up to a full ring waiting in between
+        blt::u64 pushed = 0, next = 0;
+        for (blt::u64 round = 0; round < 300; round++)
+        {
+            for (blt::u64 i = 0; i < round % 9; i++)
+                SKY_CHECK(ring.push(make_record(pushed++)));
+            while (ring.pop(record))
+                SKY_CHECK(record.generation == next++);
+        }
+        SKY_CHECK(next == pushed);
+        SKY_CHECK(ring.get_dropped() == 1);
+    }
+
+    // one producer and one consumer thread, nothing is lost or reordered when the producer retries
+    void test_threads()
+    {
+        constexpr blt::u64 count = 200000;
+        sky::telemetry_ring_t ring{64};
+        std::thread producer([&ring]()
+        {
+            for (blt::u64 i = 0; i < count; i++)
+            {
+                while (!ring.push(make_record(i)))
+                    std::this_thread::yield();
+            }
+        });
+        blt::u64 next = 0;
+        bool ordered = true;
+        sky::generation_record_t record{};
+        while (next < count)
+        {
+            if (!ring.pop(record))
+                continue;
+            ordered &= record.generation == next && record.evaluations == next * 3;
+            ++next;
+        }
+        producer.join();
+        SKY_CHECK(ordered);
+        SKY_CHECK(!ring.pop(record));
+    }
+
+    // every step pushes one record describing it, and watching a run does not change it
+    void test_run(const sky::problem_t& problem)
+    {
+        sky::telemetry_ring_t ring{16};
+        sky::genetic_algorithm watched{problem, 100, 0.8, 0.1, 31};
+        sky::genetic_algorithm unwatched{problem, 100, 0.8, 0.1, 31};
+        watched.set_telemetry(&ring);
+        watched.set_worker_count(2);
+        for (blt::u64 step = 1; step <= 10; step++)
+        {
+            watched.run_step();
+            unwatched.run_step();
+            sky::generation_record_t record{};
+            SKY_CHECK(ring.pop(record));
+            SKY_CHECK(record.generation == step);
+            SKY_CHECK(record.best_fitness == watched.best_fitness());
+            SKY_CHECK(record.average_fitness == watched.average_fitness());
+            SKY_CHECK(record.diversity == watched.get_last_diversity());
+            SKY_CHECK(record.evaluations > 0 && record.evaluations <= 100);
+            SKY_CHECK(!ring.pop(record));
+        }
+        SKY_CHECK(sky::test::digest(watched) == sky::test::digest(unwatched));
+    }
+
+    std::string read_file(const char* path)
+    {
+        std::ifstream file{path, std::ios::binary};
+        return {std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    }
+
+    // the sink drains whatever is left when destroyed
+    void test_sinks()
+    {
+        const char* csv_path = "skyscrapers-ga-telemetry.csv";
+        const char* binary_path = "skyscrapers-ga-telemetry.bin";
+        sky::telemetry_ring_t ring{32};
+        {
+            sky::telemetry_sink_t sink{ring, csv_path, sky::telemetry_format_t::CSV, std::chrono::milliseconds(1)};
+            SKY_CHECK(sink.is_open());
+            for (blt::u64 i = 1; i <= 5; i++)
+                ring.push(make_record(i));
+        }
+        const auto csv = read_file(csv_path);
+        SKY_CHECK(csv.rfind("generation,best_fitness,average_fitness,diversity,evaluations,", 0) == 0);
+        SKY_CHECK(std::count(csv.begin(), csv.end(), '\n') == 6);
+        SKY_CHECK(csv.find("\n1,1,0.25,0,3,") != std::string::npos);
+        SKY_CHECK(csv.find("\n5,5,1.25,0,15,") != std::string::npos);
+
+        {
+            sky::telemetry_sink_t sink{ring, binary_path, sky::telemetry_format_t::BINARY, std::chrono::hours(1)};
+            for (blt::u64 i = 1; i <= 20; i++)
+                ring.push(make_record(i));
+        }
+        const auto binary = read_file(binary_path);
+        SKY_CHECK(binary.size() == 12 + 20 * sizeof(sky::generation_record_t));
+        if (binary.size() == 12 + 20 * sizeof(sky::generation_record_t))
+        {
+            blt::u32 version = 0, record_size = 0;
+            std::memcpy(&version, binary.data() + 4, sizeof(version));
+            std::memcpy(&record_size, binary.data() + 8, sizeof(record_size));
+            SKY_CHECK(binary.compare(0, 4, "SKYT") == 0);
+            SKY_CHECK(version == 1 && record_size == sizeof(sky::generation_record_t));
+            for (blt::u64 i = 0; i < 20; i++)
+            {
+                sky::generation_record_t record{};
+                std::memcpy(&record, binary.data() + 12 + i * sizeof(record), sizeof(record));
+                SKY_CHECK(record.generation == i + 1 && record.evaluations == (i + 1) * 3);
+            }
+        }
+        std::remove(csv_path);
+        std::remove(binary_path);
+
+        // an unwritable path leaves the sink closed without a thread to stop
+        sky::telemetry_sink_t closed{ring, "missing-directory/telemetry.csv", sky::telemetry_format_t::CSV};
+        SKY_CHECK(!closed.is_open());
+    }
+}
+
+int main()
+{
+    sky::puzzle_generator_t generator{15};
+    const auto puzzle = generator.generate(6);
+    test_ring();
+    test_threads();
+    test_run(puzzle.problem);
+    test_sinks();
+    return sky::test::finish("telemetry");
+}
@@ -0,0 +1,90 @@
+#pragma once
+/*
+ *  Copyright (C) 2024  Brett Terpstra
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SKYSCRAPERS_GA_TEST_H
+#define SKYSCRAPERS_GA_TEST_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <genetic_algorithm.h>
+#include <rng.h>
+#include <vector>
+
+// minimal checks shared by the test programs. a failed check prints FAIL (which ctest matches on) and the program exits non zero
+namespace sky::test
+{
+    inline int failures = 0;
+
+    inline void check(const bool condition, const char* what, const char* file, const int line)
+    {
+        if (condition)
+            return;
+        ++failures;
+        std::printf("FAIL %s:%d: %s\n", file, line, what);
+    }
+
+    // folds every board and score of the population into one value, runs that went the same way give equal digests
+    inline blt::u64 digest(const population_t& population)
+    {
+        blt::u64 hash = 0;
+        for (blt::size_t i = 0; i < population.size(); i++)
+        {
+            hash = rng::mix(hash ^ population.hash(i));
+            hash = rng::mix(hash ^ static_cast<blt::u64>(population.fitness(i)));
+        }
+        return hash;
+    }
+
+    inline blt::u64 digest(const genetic_algorithm& ga)
+    {
+        return digest(ga.get_population());
+    }
+
+    // every row and column holds each value exactly once
+    inline bool latin(const solution_t& solution)
+    {
+        const auto size = solution.board_size;
+        for (blt::i32 line = 0; line < size; line++)
+        {
+            std::vector<bool> in_row(size + 1), in_column(size + 1);
+            for (blt::i32 i = 0; i < size; i++)
+            {
+                const auto row_value = solution.board_data[line * size + i];
+                const auto column_value = solution.board_data[i * size + line];
+                if (row_value < 1 || row_value > size || column_value < 1 || column_value > size)
+                    return false;
+                if (in_row[row_value] || in_column[column_value])
+                    return false;
+                in_row[row_value] = true;
+                in_column[column_value] = true;
+            }
+        }
+        return true;
+    }
+
+    inline int finish(const char* name)
+    {
+        if (failures == 0)
+            std::printf("%s passed\n", name);
+        return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+}
+
+#define SKY_CHECK(condition) sky::test::check(condition, #condition, __FILE__, __LINE__)
+
+#endif //SKYSCRAPERS_GA_TEST_H